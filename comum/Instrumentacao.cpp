@@ -0,0 +1,305 @@
+#include "Instrumentacao.h"
+
+#ifdef INSTRUMENTACAO
+
+#include <algorithm>
+#include <bit>
+#include <chrono>
+#include <cstdlib>
+#include <mutex>
+#include <new>
+#include <sstream>
+#include <vector>
+
+#ifdef _MSC_VER
+#include <malloc.h>
+#endif
+
+// ============================================================================
+// CONTAGEM DE ALOCACOES
+// ============================================================================
+// operator new/delete sao substituidos (so com INSTRUMENTACAO ligada) para
+// contar, por thread, quantas alocacoes e quantos bytes ja foram pedidos.
+// Cada Medicao guarda os contadores no inicio e subtrai-os no fim.
+//
+// Sao substituidas todas as formas (simples, [], nothrow e alinhadas, para
+// tipos com alignas maior do que o do malloc), cada uma com o delete que
+// lhe corresponde: a memoria alinhada vem de um alocador diferente e tem de
+// ser libertada por ele.
+// ============================================================================
+static thread_local uint64_t alocacoesThread = 0;
+static thread_local uint64_t bytesThread = 0;
+
+void* operator new(std::size_t tamanho) {
+	alocacoesThread++;
+	bytesThread += tamanho;
+	void* p = std::malloc(tamanho == 0 ? 1 : tamanho);
+	if (p == nullptr) {
+		throw std::bad_alloc();
+	}
+	return p;
+}
+
+void* operator new[](std::size_t tamanho) {
+	return operator new(tamanho);
+}
+
+void operator delete(void* p) noexcept {
+	std::free(p);
+}
+
+void operator delete[](void* p) noexcept {
+	std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept {
+	std::free(p);
+}
+
+void operator delete[](void* p, std::size_t) noexcept {
+	std::free(p);
+}
+
+void* operator new(std::size_t tamanho, const std::nothrow_t&) noexcept {
+	try {
+		return operator new(tamanho);
+	}
+	catch (...) {
+		return nullptr;
+	}
+}
+
+void* operator new[](std::size_t tamanho, const std::nothrow_t&) noexcept {
+	return operator new(tamanho, std::nothrow);
+}
+
+void operator delete(void* p, const std::nothrow_t&) noexcept {
+	std::free(p);
+}
+
+void operator delete[](void* p, const std::nothrow_t&) noexcept {
+	std::free(p);
+}
+
+// Alinhadas: _aligned_malloc no MSVC (o std::aligned_alloc nao existe la),
+// std::aligned_alloc no resto (que exige um tamanho multiplo do alinhamento)
+void* operator new(std::size_t tamanho, std::align_val_t alinhamento) {
+	alocacoesThread++;
+	bytesThread += tamanho;
+	std::size_t a = (std::size_t)alinhamento;
+#ifdef _MSC_VER
+	void* p = _aligned_malloc(tamanho == 0 ? 1 : tamanho, a);
+#else
+	void* p = std::aligned_alloc(a, tamanho == 0 ? a : (tamanho + a - 1) / a * a);
+#endif
+	if (p == nullptr) {
+		throw std::bad_alloc();
+	}
+	return p;
+}
+
+void* operator new[](std::size_t tamanho, std::align_val_t alinhamento) {
+	return operator new(tamanho, alinhamento);
+}
+
+void* operator new(std::size_t tamanho, std::align_val_t alinhamento, const std::nothrow_t&) noexcept {
+	try {
+		return operator new(tamanho, alinhamento);
+	}
+	catch (...) {
+		return nullptr;
+	}
+}
+
+void* operator new[](std::size_t tamanho, std::align_val_t alinhamento, const std::nothrow_t&) noexcept {
+	return operator new(tamanho, alinhamento, std::nothrow);
+}
+
+static void libertarAlinhado(void* p) {
+#ifdef _MSC_VER
+	_aligned_free(p);
+#else
+	std::free(p);
+#endif
+}
+
+void operator delete(void* p, std::align_val_t) noexcept {
+	libertarAlinhado(p);
+}
+
+void operator delete[](void* p, std::align_val_t) noexcept {
+	libertarAlinhado(p);
+}
+
+void operator delete(void* p, std::size_t, std::align_val_t) noexcept {
+	libertarAlinhado(p);
+}
+
+void operator delete[](void* p, std::size_t, std::align_val_t) noexcept {
+	libertarAlinhado(p);
+}
+
+void operator delete(void* p, std::align_val_t, const std::nothrow_t&) noexcept {
+	libertarAlinhado(p);
+}
+
+void operator delete[](void* p, std::align_val_t, const std::nothrow_t&) noexcept {
+	libertarAlinhado(p);
+}
+
+namespace Instrumentacao {
+
+	namespace {
+		// Lista de todas as operacoes medidas (cada MEDIR regista a sua na primeira chamada)
+		std::mutex& mutexOperacoes() {
+			static std::mutex m;
+			return m;
+		}
+
+		std::vector<Operacao*>& operacoes() {
+			static std::vector<Operacao*> lista;
+			return lista;
+		}
+
+		uint64_t agoraNs() {
+			return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+				std::chrono::steady_clock::now().time_since_epoch()).count();
+		}
+	}
+
+	// ========================================================================
+	// HISTOGRAMA
+	// ========================================================================
+	// Valores 0..15 tem um balde cada. A partir dai, para um valor com o bit
+	// mais alto na posicao e, os 4 bits seguintes escolhem um de 16 baldes:
+	//
+	//   valor = 1 0110 xxxxxx (binario), e = 10  ->  balde (10-3)*16 + 0110
+	// ========================================================================
+	int Histograma::balde(uint64_t valor) {
+		if (valor < SUB_BALDES) {
+			return (int)valor;
+		}
+		int e = std::bit_width(valor) - 1;	// posicao do bit mais alto (>= 4)
+		int sub = (int)((valor >> (e - 4)) & (SUB_BALDES - 1));
+		return (e - 3) * SUB_BALDES + sub;
+	}
+
+	uint64_t Histograma::inicioBalde(int b) {
+		if (b < SUB_BALDES) {
+			return (uint64_t)b;
+		}
+		int e = b / SUB_BALDES + 3;
+		uint64_t sub = (uint64_t)(b % SUB_BALDES);
+		return (SUB_BALDES + sub) << (e - 4);
+	}
+
+	Histograma::Histograma() : maximo(0) {
+		for (int i = 0; i < NUM_BALDES; i++) {
+			contagens[i].store(0, std::memory_order_relaxed);
+		}
+	}
+
+	void Histograma::registar(uint64_t valor) {
+		contagens[balde(valor)].fetch_add(1, std::memory_order_relaxed);
+
+		uint64_t atual = maximo.load(std::memory_order_relaxed);
+		while (valor > atual && !maximo.compare_exchange_weak(atual, valor, std::memory_order_relaxed)) {
+		}
+	}
+
+	uint64_t Histograma::percentil(double p) const {
+		uint64_t total = 0;
+		for (int i = 0; i < NUM_BALDES; i++) {
+			total += contagens[i].load(std::memory_order_relaxed);
+		}
+		if (total == 0) {
+			return 0;
+		}
+
+		uint64_t alvo = (uint64_t)(p / 100.0 * (double)total);
+		if (alvo == 0) {
+			alvo = 1;
+		}
+		uint64_t acumulado = 0;
+		for (int i = 0; i < NUM_BALDES; i++) {
+			acumulado += contagens[i].load(std::memory_order_relaxed);
+			if (acumulado >= alvo) {
+				return std::min(inicioBalde(i), getMaximo());
+			}
+		}
+		return getMaximo();
+	}
+
+	// ========================================================================
+	// OPERACAO / MEDICAO
+	// ========================================================================
+	Operacao::Operacao(const char* nomeP) : nome(nomeP), chamadas(0), totalNs(0), alocacoes(0), bytes(0) {
+		std::lock_guard<std::mutex> lock(mutexOperacoes());
+		operacoes().push_back(this);
+	}
+
+	void Operacao::registar(uint64_t ns, uint64_t numAlocacoes, uint64_t numBytes) {
+		chamadas.fetch_add(1, std::memory_order_relaxed);
+		totalNs.fetch_add(ns, std::memory_order_relaxed);
+		alocacoes.fetch_add(numAlocacoes, std::memory_order_relaxed);
+		bytes.fetch_add(numBytes, std::memory_order_relaxed);
+		latencias.registar(ns);
+	}
+
+	Medicao::Medicao(Operacao& operacaoP) :
+		operacao(operacaoP), inicioNs(agoraNs()), alocacoesInicio(alocacoesThread), bytesInicio(bytesThread) {
+	}
+
+	Medicao::~Medicao() {
+		operacao.registar(agoraNs() - inicioNs, alocacoesThread - alocacoesInicio, bytesThread - bytesInicio);
+	}
+
+	// ========================================================================
+	// EXPORTAR
+	// ========================================================================
+	// Texto: uma linha por operacao, campos separados por espacos
+	//   operacao chamadas total_ns media_ns p50_ns p90_ns p99_ns p999_ns max_ns alocacoes bytes
+	// JSON: {"operacoes":[{"nome":"...","chamadas":...,...}, ...]}
+	// ========================================================================
+	std::string exportarTexto() {
+		std::lock_guard<std::mutex> lock(mutexOperacoes());
+		std::ostringstream oss;
+
+		oss << "operacao chamadas total_ns media_ns p50_ns p90_ns p99_ns p999_ns max_ns alocacoes bytes" << std::endl;
+		for (const Operacao* op : operacoes()) {
+			uint64_t n = op->chamadas.load();
+			oss << op->nome << " " << n << " " << op->totalNs.load() << " " << (n ? op->totalNs.load() / n : 0)
+				<< " " << op->latencias.percentil(50) << " " << op->latencias.percentil(90)
+				<< " " << op->latencias.percentil(99) << " " << op->latencias.percentil(99.9)
+				<< " " << op->latencias.getMaximo() << " " << op->alocacoes.load() << " " << op->bytes.load() << std::endl;
+		}
+		return oss.str();
+	}
+
+	std::string exportarJSON() {
+		std::lock_guard<std::mutex> lock(mutexOperacoes());
+		std::ostringstream oss;
+
+		oss << "{\"operacoes\":[";
+		bool primeira = true;
+		for (const Operacao* op : operacoes()) {
+			uint64_t n = op->chamadas.load();
+			oss << (primeira ? "" : ",") << "{\"nome\":\"" << op->nome << "\""
+				<< ",\"chamadas\":" << n
+				<< ",\"total_ns\":" << op->totalNs.load()
+				<< ",\"media_ns\":" << (n ? op->totalNs.load() / n : 0)
+				<< ",\"p50_ns\":" << op->latencias.percentil(50)
+				<< ",\"p90_ns\":" << op->latencias.percentil(90)
+				<< ",\"p99_ns\":" << op->latencias.percentil(99)
+				<< ",\"p999_ns\":" << op->latencias.percentil(99.9)
+				<< ",\"max_ns\":" << op->latencias.getMaximo()
+				<< ",\"alocacoes\":" << op->alocacoes.load()
+				<< ",\"bytes\":" << op->bytes.load() << "}";
+			primeira = false;
+		}
+		oss << "]}" << std::endl;
+		return oss.str();
+	}
+}
+
+#endif
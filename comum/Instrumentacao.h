@@ -0,0 +1,123 @@
+#pragma once
+#include <string>
+
+// ============================================================================
+// INSTRUMENTACAO (opcional, ligada em tempo de compilacao)
+// ============================================================================
+// Mede, por operacao (ex: "ArmarioFichas::registarConsulta"):
+//   - numero de chamadas
+//   - latencia: histograma ao estilo HDR (p50, p90, p99, p99.9, maximo)
+//   - alocacoes de memoria (numero e bytes) feitas durante a operacao
+//
+// Para ligar: definir INSTRUMENTACAO no projeto
+//   (Propriedades > C/C++ > Preprocessor > Preprocessor Definitions,
+//    ou -DINSTRUMENTACAO na linha de comandos).
+//
+// DESLIGADA (por omissao): MEDIR(...) nao gera codigo nenhum e operator new
+// nao e substituido, ou seja, custo zero.
+//
+// Uso numa funcao:
+//   bool ArmarioFichas::registarConsulta(int nif) {
+//       MEDIR("ArmarioFichas::registarConsulta");
+//       ...
+//   }
+//
+// Exportar (ex: para um sistema de monitorizacao ler):
+//   std::cout << Instrumentacao::exportarTexto();
+//   std::cout << Instrumentacao::exportarJSON();
+// Ja exportado por:
+//   ex2 --servidor        comandos METRICS / METRICS JSON (ver ServidorComandos.h)
+//   ex2_bench --metricas  no fim, em stderr
+//
+// As alocacoes contadas sao todas as formas de operator new / new[] (normal,
+// nothrow, alinhada e alinhada nothrow).
+// ============================================================================
+
+#ifdef INSTRUMENTACAO
+
+#include <atomic>
+#include <cstdint>
+
+namespace Instrumentacao {
+
+	// Histograma log-linear: cada potencia de 2 esta dividida em 16 "baldes"
+	// iguais, por isso qualquer valor fica registado com erro <= 1/16 (~6%),
+	// de 1 ns a centenas de anos, com um array de tamanho fixo.
+	class Histograma {
+	public:
+		static const int SUB_BALDES = 16;
+		static const int NUM_BALDES = (64 - 3) * SUB_BALDES;
+
+	private:
+		std::atomic<uint64_t> contagens[NUM_BALDES];
+		std::atomic<uint64_t> maximo;
+
+		static int balde(uint64_t valor);
+		static uint64_t inicioBalde(int balde);
+
+	public:
+		Histograma();
+
+		void registar(uint64_t valor);
+
+		//Valor abaixo do qual estao 'percentil' % das amostras (0..100)
+		uint64_t percentil(double percentil) const;
+		uint64_t getMaximo() const { return maximo.load(std::memory_order_relaxed); }
+	};
+
+	// Estatisticas de uma operacao (um objeto static por cada MEDIR no codigo)
+	class Operacao {
+		const char* nome;
+		std::atomic<uint64_t> chamadas;
+		std::atomic<uint64_t> totalNs;
+		std::atomic<uint64_t> alocacoes;
+		std::atomic<uint64_t> bytes;
+		Histograma latencias;
+
+		friend std::string exportarTexto();
+		friend std::string exportarJSON();
+
+	public:
+		explicit Operacao(const char* nomeP);	// regista-se na lista global
+
+		Operacao(const Operacao&) = delete;
+		Operacao& operator=(const Operacao&) = delete;
+
+		void registar(uint64_t ns, uint64_t numAlocacoes, uint64_t numBytes);
+	};
+
+	// Mede desde a construcao ate a destruicao (fim do bloco)
+	class Medicao {
+		Operacao& operacao;
+		uint64_t inicioNs;
+		uint64_t alocacoesInicio;
+		uint64_t bytesInicio;
+
+	public:
+		explicit Medicao(Operacao& operacaoP);
+		~Medicao();
+
+		Medicao(const Medicao&) = delete;
+		Medicao& operator=(const Medicao&) = delete;
+	};
+
+	std::string exportarTexto();
+	std::string exportarJSON();
+}
+
+#define MEDIR_CONCAT2(a, b) a##b
+#define MEDIR_CONCAT(a, b) MEDIR_CONCAT2(a, b)
+#define MEDIR(nome) \
+	static Instrumentacao::Operacao MEDIR_CONCAT(operacao_, __LINE__)(nome); \
+	Instrumentacao::Medicao MEDIR_CONCAT(medicao_, __LINE__)(MEDIR_CONCAT(operacao_, __LINE__))
+
+#else
+
+namespace Instrumentacao {
+	inline std::string exportarTexto() { return std::string(); }
+	inline std::string exportarJSON() { return "{\"operacoes\":[]}\n"; }
+}
+
+#define MEDIR(nome) ((void)0)
+
+#endif
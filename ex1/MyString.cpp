@@ -1,4 +1,5 @@
 #include "MyString.h"
+#include "../comum/Instrumentacao.h"
 
 MyString::MyString(const char* str) {
 	string = new char[strlen(str) + 1];
@@ -71,6 +72,8 @@ MyString& MyString::operator=(const MyString& outra) {
 }
 
 void MyString::acrescenta(const char* str) {
+	MEDIR("MyString::acrescenta");
+
 	// MyString a("Ola"); a.acrescenta("Mundo"); 
 	// Resultado esperado: "OlaMundo"
 	// Calcular o tamanho total necessario que  a soma entre a (string atual + string a acrescentar)
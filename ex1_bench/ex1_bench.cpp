@@ -0,0 +1,205 @@
+// ex1_bench.cpp : Microbenchmark da MyString com contagem de alocacoes.
+//
+// Cada caso corre muitas vezes a mesma operacao e reporta, por operacao:
+//   ns_por_op          tempo medio
+//   alocacoes_por_op   chamadas a operator new / new[]
+//   bytes_por_op       bytes pedidos a operator new / new[]
+//
+// Casos (a coluna 'tamanho' e o tamanho da string usada):
+//   construir_literal  MyString s("...")
+//   copia              MyString b(a)
+//   atribuicao         b = a
+//   acrescenta         s.acrescenta(pedaco) repetido; 'tamanho' = tamanho do pedaco
+//                      (a string cresce ate 'repeticoes' pedacos e volta ao inicio)
+//   muda_char_at       s.mudaCharAt(i, c) em todas as posicoes
+//   get_tamanho        s.getTamanho()
+//
+// Resultado em CSV (omissao) ou JSON (uma linha por objeto):
+//   caso,tamanho,iteracoes,ns_por_op,alocacoes_por_op,bytes_por_op
+//
+// Uso:
+//   ex1_bench [--iter N] [--repeticoes N] [--json]
+//     --iter         operacoes por caso                          (omissao: 200000)
+//     --repeticoes   acrescenta seguidos antes de recomecar       (omissao: 64)
+//     --json         escreve JSON em vez de CSV
+//
+// Nota: este projeto substitui operator new/delete para contar alocacoes, por
+// isso nao pode ser compilado com INSTRUMENTACAO (que tambem os substitui).
+
+#include "../ex1/MyString.h"
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <string>
+
+#ifdef INSTRUMENTACAO
+#error "ex1_bench conta as alocacoes com o seu proprio operator new: compilar sem INSTRUMENTACAO"
+#endif
+
+// ============================================================================
+// CONTAGEM DE ALOCACOES
+// ============================================================================
+// Todas as alocacoes do programa passam por aqui. O benchmark le os
+// contadores antes e depois de cada caso e divide pelo numero de operacoes.
+// ============================================================================
+static uint64_t numAlocacoes = 0;
+static uint64_t numBytes = 0;
+
+void* operator new(std::size_t tamanho) {
+	numAlocacoes++;
+	numBytes += tamanho;
+	void* p = std::malloc(tamanho == 0 ? 1 : tamanho);
+	if (p == nullptr) {
+		throw std::bad_alloc();
+	}
+	return p;
+}
+
+void* operator new[](std::size_t tamanho) {
+	return operator new(tamanho);
+}
+
+void operator delete(void* p) noexcept {
+	std::free(p);
+}
+
+void operator delete[](void* p) noexcept {
+	std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept {
+	std::free(p);
+}
+
+void operator delete[](void* p, std::size_t) noexcept {
+	std::free(p);
+}
+
+namespace {
+
+	struct Opcoes {
+		int iteracoes = 200000;
+		int repeticoes = 64;
+		bool json = false;
+	};
+
+	// Soma de tudo o que os casos produzem (impede o compilador de apagar o trabalho)
+	volatile uint64_t sumidouro = 0;
+
+	void consumir(uint64_t v) {
+		sumidouro = sumidouro + v;
+	}
+
+	// Corre 'iteracoes' vezes a funcao 'op(i)' e escreve uma linha de resultados
+	template <typename Op>
+	void medir(const Opcoes& opcoes, const char* caso, size_t tamanho, Op op) {
+		using relogio = std::chrono::steady_clock;
+
+		uint64_t alocacoesInicio = numAlocacoes;
+		uint64_t bytesInicio = numBytes;
+		auto inicio = relogio::now();
+
+		for (int i = 0; i < opcoes.iteracoes; i++) {
+			op(i);
+		}
+
+		double ns = std::chrono::duration<double, std::nano>(relogio::now() - inicio).count();
+		double n = opcoes.iteracoes;
+		double nsPorOp = ns / n;
+		double alocacoesPorOp = (double)(numAlocacoes - alocacoesInicio) / n;
+		double bytesPorOp = (double)(numBytes - bytesInicio) / n;
+
+		if (opcoes.json) {
+			std::cout << "{\"caso\":\"" << caso << "\",\"tamanho\":" << tamanho << ",\"iteracoes\":" << opcoes.iteracoes
+				<< ",\"ns_por_op\":" << nsPorOp << ",\"alocacoes_por_op\":" << alocacoesPorOp
+				<< ",\"bytes_por_op\":" << bytesPorOp << "}" << std::endl;
+		}
+		else {
+			std::cout << caso << "," << tamanho << "," << opcoes.iteracoes << "," << nsPorOp << ","
+				<< alocacoesPorOp << "," << bytesPorOp << std::endl;
+		}
+	}
+
+	void correrTamanho(const Opcoes& opcoes, size_t tamanho) {
+		std::string texto(tamanho, 'a');
+		const char* literal = texto.c_str();
+
+		medir(opcoes, "construir_literal", tamanho, [&](int) {
+			MyString s(literal);
+			consumir((unsigned char)s.obtemCString()[0]);
+		});
+
+		MyString original(literal);
+		medir(opcoes, "copia", tamanho, [&](int) {
+			MyString copia(original);
+			consumir((unsigned char)copia.obtemCString()[0]);
+		});
+
+		// Destinos alternados com tamanhos diferentes, para cada atribuicao mudar mesmo o conteudo
+		MyString curta("b");
+		MyString destino("c");
+		medir(opcoes, "atribuicao", tamanho, [&](int i) {
+			destino = (i % 2 == 0) ? original : curta;
+			consumir((unsigned char)destino.obtemCString()[0]);
+		});
+
+		MyString acumulada;
+		medir(opcoes, "acrescenta", tamanho, [&](int i) {
+			if (i % opcoes.repeticoes == 0) {
+				acumulada = MyString();
+			}
+			acumulada.acrescenta(literal);
+		});
+		consumir((unsigned char)acumulada.obtemCString()[0]);
+
+		MyString alvo(literal);
+		medir(opcoes, "muda_char_at", tamanho, [&](int i) {
+			consumir(alvo.mudaCharAt(i % (int)tamanho, (char)('a' + (i & 15))));
+		});
+
+		medir(opcoes, "get_tamanho", tamanho, [&](int) {
+			consumir(alvo.getTamanho());
+		});
+	}
+
+	bool lerOpcoes(int argc, char** argv, Opcoes& opcoes) {
+		for (int i = 1; i < argc; i++) {
+			std::string a = argv[i];
+			bool temValor = i + 1 < argc;
+			if (a == "--iter" && temValor) {
+				opcoes.iteracoes = std::atoi(argv[++i]);
+			}
+			else if (a == "--repeticoes" && temValor) {
+				opcoes.repeticoes = std::atoi(argv[++i]);
+			}
+			else if (a == "--json") {
+				opcoes.json = true;
+			}
+			else {
+				return false;
+			}
+		}
+		return opcoes.iteracoes > 0 && opcoes.repeticoes > 0;
+	}
+}
+
+int main(int argc, char** argv)
+{
+	Opcoes opcoes;
+	if (!lerOpcoes(argc, argv, opcoes)) {
+		std::cerr << "Uso: ex1_bench [--iter N] [--repeticoes N] [--json]" << std::endl;
+		return 1;
+	}
+
+	if (!opcoes.json) {
+		std::cout << "caso,tamanho,iteracoes,ns_por_op,alocacoes_por_op,bytes_por_op" << std::endl;
+	}
+	// Curta (cabe numa SSO tipica), media e longa
+	const size_t tamanhos[] = { 8, 64, 1024 };
+	for (size_t tamanho : tamanhos) {
+		correrTamanho(opcoes, tamanho);
+	}
+	return 0;
+}
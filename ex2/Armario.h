@@ -0,0 +1,403 @@
+#pragma once
+#include <algorithm>
+#include <functional>
+#include <span>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// ============================================================================
+// ARMARIO GENERICO
+// ============================================================================
+// O nucleo de qualquer "armario de fichas": um array dinamico de registos,
+// cada um identificado por uma chave, com apagar por swap-and-pop.
+//
+//   Armario<Registo, Extrator, Indice>
+//     Registo   tipo guardado (ex: Cliente)
+//     Extrator  funcao que da a chave de um registo (ex: NIF do Cliente)
+//     Indice    politica de procura pela chave, escolhida em tempo de
+//               compilacao (sem funcoes virtuais):
+//                 IndiceLinear   - chaves num array contiguo, procura linear
+//                                  em blocos (o compilador usa SIMD)
+//                 IndiceHash     - tabela de hash chave -> posicao, O(1)
+//                 IndiceOrdenado - pares (chave, posicao) ordenados,
+//                                  pesquisa binaria O(log n)
+//
+// Exemplo de uso:
+//   struct NifDoCliente {
+//       int operator()(const Cliente& c) const { return c.obtemNIF(); }
+//   };
+//   Armario<Cliente, NifDoCliente, IndiceLinear> clientes;
+//   clientes.acrescentar(new Cliente("Joao", 111));   // o armario fica dono do objeto
+//                                                     // (NIF repetido: verificar antes com posicaoDe)
+//   int i = clientes.posicaoDe(111);                  // 0
+//   clientes.remover(i);
+//
+// O ArmarioFichas e uma destas instanciacoes (ver ArmarioFichas.h), mais os
+// indices e caches proprios dos clientes.
+// ============================================================================
+
+// ----------------------------------------------------------------------------
+// Politicas de indice: todas tem a mesma interface
+//   int procurar(const Chave& c) const          posicao do registo com a chave c (-1 se nao existir)
+//   void acrescentado(const Chave& c, int pos)  novo registo na posicao pos (sempre a ultima)
+//   void acrescentadosVarios(std::span<const Chave> cs, int posInicial)
+//                                               novos registos nas posicoes posInicial, posInicial+1, ...
+//   void removido(const Chave& c, int pos, const Chave& ultima, int posUltima)
+//                                               o registo c (posicao pos) saiu e o ultimo
+//                                               (chave 'ultima', posicao posUltima) passou para pos
+//   void limpar()
+// ----------------------------------------------------------------------------
+
+template <typename Chave>
+class IndiceLinear
+{
+	std::vector<Chave> chaves;	// chaves[i] = chave do registo na posicao i
+
+public:
+	int procurar(const Chave& c) const {
+		const Chave* p = chaves.data();
+		int n = (int)chaves.size();
+		int i = 0;
+		// Blocos de 8 sem saida a meio: o compilador compara o bloco inteiro com SIMD
+		for (; i + 8 <= n; i += 8) {
+			bool algum = false;
+			for (int j = 0; j < 8; j++) {
+				algum |= p[i + j] == c;
+			}
+			if (algum) {
+				break;
+			}
+		}
+		for (; i < n; i++) {
+			if (p[i] == c) {
+				return i;
+			}
+		}
+		return -1;
+	}
+
+	void acrescentado(const Chave& c, int) { chaves.push_back(c); }
+
+	void acrescentadosVarios(std::span<const Chave> cs, int) { chaves.insert(chaves.end(), cs.begin(), cs.end()); }
+
+	void removido(const Chave&, int pos, const Chave&, int posUltima) {
+		chaves[pos] = chaves[posUltima];	// mesmo swap-and-pop que o armario
+		chaves.pop_back();
+	}
+
+	void limpar() { chaves.clear(); }
+};
+
+template <typename Chave>
+class IndiceHash
+{
+	std::unordered_map<Chave, int> posicoes;
+
+public:
+	int procurar(const Chave& c) const {
+		auto p = posicoes.find(c);
+		return p != posicoes.end() ? p->second : -1;
+	}
+
+	void acrescentado(const Chave& c, int pos) { posicoes.emplace(c, pos); }
+
+	void acrescentadosVarios(std::span<const Chave> cs, int posInicial) {
+		posicoes.reserve(posicoes.size() + cs.size());
+		for (int k = 0; k < (int)cs.size(); k++) {
+			posicoes.emplace(cs[k], posInicial + k);
+		}
+	}
+
+	void removido(const Chave& c, int pos, const Chave& ultima, int posUltima) {
+		posicoes.erase(c);
+		if (pos != posUltima) {
+			posicoes[ultima] = pos;
+		}
+	}
+
+	void limpar() { posicoes.clear(); }
+};
+
+template <typename Chave>
+class IndiceOrdenado
+{
+	std::vector<std::pair<Chave, int>> entradas;	// (chave, posicao), ordenados pela chave
+
+	typename std::vector<std::pair<Chave, int>>::const_iterator encontrar(const Chave& c) const {
+		return std::lower_bound(entradas.begin(), entradas.end(), c,
+			[](const std::pair<Chave, int>& e, const Chave& k) { return e.first < k; });
+	}
+
+public:
+	int procurar(const Chave& c) const {
+		auto p = encontrar(c);
+		return p != entradas.end() && p->first == c ? p->second : -1;
+	}
+
+	void acrescentado(const Chave& c, int pos) { entradas.insert(encontrar(c), std::make_pair(c, pos)); }
+
+	// Os novos sao ordenados entre si e depois fundidos com os existentes: O(n + m log m)
+	void acrescentadosVarios(std::span<const Chave> cs, int posInicial) {
+		size_t meio = entradas.size();
+		for (int k = 0; k < (int)cs.size(); k++) {
+			entradas.emplace_back(cs[k], posInicial + k);
+		}
+		std::sort(entradas.begin() + meio, entradas.end());
+		std::inplace_merge(entradas.begin(), entradas.begin() + meio, entradas.end());
+	}
+
+	void removido(const Chave& c, int pos, const Chave& ultima, int posUltima) {
+		entradas.erase(encontrar(c));
+		if (pos != posUltima) {
+			auto p = encontrar(ultima);
+			entradas[p - entradas.begin()].second = pos;
+		}
+	}
+
+	void limpar() { entradas.clear(); }
+};
+
+template <typename Registo, typename Extrator, template <typename> class Indice>
+class Armario
+{
+public:
+	using Chave = std::remove_cvref_t<std::invoke_result_t<Extrator, const Registo&>>;
+
+private:
+	Registo** registos;		// Array dinamico de ponteiros para Registo
+
+	// Registo* seria um array de OBJETOS, o que exigiria um construtor
+	// default Registo() (new Registo[n] chama-o n vezes). Um Cliente, por
+	// exemplo, nao tem construtor default, logo Registo** (array de ponteiros):
+	//   - new Registo*[n] cria apenas n PONTEIROS (nao objetos)
+	//   - Cada registo e criado INDIVIDUALMENTE quando ha dados validos
+
+	int numRegistos;		// Numero atual de registos
+	Indice<Chave> indice;	// Chave -> posicao em 'registos'
+
+	static Chave chaveDe(const Registo& r) { return Extrator{}(r); }
+
+public:
+	//Construtor
+	Armario() : registos(nullptr), numRegistos(0) {}
+
+	//Construtor por Copia (deep copy: cada registo e copiado)
+	Armario(const Armario& outro);
+
+	//Operador de Atribuicao (deep copy)
+	Armario& operator=(const Armario& outro);
+
+	//Destrutor (apaga todos os registos)
+	~Armario() { esvaziar(); }
+
+	//Getters
+	int getNumRegistos() const { return numRegistos; }
+	Registo* operator[](int pos) const { return registos[pos]; }
+
+	//Posicao do registo com esta chave (-1 se nao existir)
+	int posicaoDe(const Chave& c) const { return indice.procurar(c); }
+
+	//Acrescentar um registo criado com new (o armario fica dono dele); a chave tem de ser nova (ver posicaoDe)
+	void acrescentar(Registo* novo);
+
+	//Acrescentar varios registos de uma vez (um so array novo); as chaves tem de ser todas novas
+	void acrescentarVarios(std::span<Registo* const> novos);
+
+	//Apagar o registo da posicao 'pos' (o ultimo passa para essa posicao)
+	void remover(int pos);
+
+	//Apagar de uma vez os registos com marcados[pos] != 0 (os outros ficam pela mesma ordem)
+	void removerMarcados(std::span<const char> marcados);
+
+	//Apagar todos os registos
+	void esvaziar();
+};
+
+// ============================================================================
+// CONSTRUTOR POR COPIA / OPERADOR DE ATRIBUICAO (Deep Copy)
+// ============================================================================
+// Cada registo e copiado com o construtor por copia de Registo, para um array
+// NOVO. Arrays DIFERENTES, Objetos DIFERENTES, Dados IGUAIS:
+//
+//   outro.registos -> [ptrA][ptrB][ptrC]
+//                       ↓     ↓     ↓
+//                    RegistoA RegistoB RegistoC
+//
+//   this->registos -> [ptr0][ptr1][ptr2]  (NOVO array)
+//                       ↓     ↓     ↓
+//                    Registo0 Registo1 Registo2 (NOVOS objetos, dados iguais!)
+//
+// O indice e copiado tal e qual: as posicoes sao as mesmas.
+// ============================================================================
+template <typename Registo, typename Extrator, template <typename> class Indice>
+Armario<Registo, Extrator, Indice>::Armario(const Armario& outro) :
+	registos(nullptr), numRegistos(outro.numRegistos), indice(outro.indice) {
+	if (numRegistos > 0) {
+		registos = new Registo * [numRegistos];
+		for (int i = 0; i < numRegistos; i++) {
+			registos[i] = new Registo(*outro.registos[i]);
+		}
+	}
+}
+
+template <typename Registo, typename Extrator, template <typename> class Indice>
+Armario<Registo, Extrator, Indice>& Armario<Registo, Extrator, Indice>::operator=(const Armario& outro) {
+	// Auto-atribuicao (a = a): apagar primeiro destruiria o que se vai copiar
+	if (this == &outro) {
+		return *this;
+	}
+
+	esvaziar();
+
+	if (outro.numRegistos > 0) {
+		registos = new Registo * [outro.numRegistos];
+		for (int i = 0; i < outro.numRegistos; i++) {
+			registos[i] = new Registo(*outro.registos[i]);
+		}
+	}
+	numRegistos = outro.numRegistos;
+	indice = outro.indice;
+
+	return *this;
+}
+
+// ============================================================================
+// ACRESCENTAR
+// ============================================================================
+// Cria um array NOVO com mais uma posicao, copia os PONTEIROS (nao os
+// objetos) e poe o novo registo no fim:
+//
+//   registos -> [ptr0][ptr1][ptr2]
+//                 ↓     ↓     ↓
+//   registosTemp -> [ptr0][ptr1][ptr2][ptrNovo]
+//
+// Depois 'delete[] registos' liberta so o array antigo (os "slots"), os
+// objetos continuam vivos porque 'registosTemp' ainda aponta para eles.
+// ============================================================================
+template <typename Registo, typename Extrator, template <typename> class Indice>
+void Armario<Registo, Extrator, Indice>::acrescentar(Registo* novo) {
+	Registo** registosTemp = new Registo * [numRegistos + 1];
+	for (int i = 0; i < numRegistos; i++) {
+		registosTemp[i] = registos[i];
+	}
+	registosTemp[numRegistos] = novo;
+
+	delete[] registos;
+	registos = registosTemp;
+
+	indice.acrescentado(chaveDe(*novo), numRegistos);
+	numRegistos++;
+}
+
+// Mesma ideia, mas o array novo ja tem o tamanho final: UMA realocacao por lote
+template <typename Registo, typename Extrator, template <typename> class Indice>
+void Armario<Registo, Extrator, Indice>::acrescentarVarios(std::span<Registo* const> novos) {
+	if (novos.empty()) {
+		return;
+	}
+
+	int total = numRegistos + (int)novos.size();
+	Registo** registosTemp = new Registo * [total];
+	for (int i = 0; i < numRegistos; i++) {
+		registosTemp[i] = registos[i];
+	}
+
+	std::vector<Chave> chaves;
+	chaves.reserve(novos.size());
+	for (int k = 0; k < (int)novos.size(); k++) {
+		registosTemp[numRegistos + k] = novos[k];
+		chaves.push_back(chaveDe(*novos[k]));
+	}
+
+	delete[] registos;
+	registos = registosTemp;
+
+	indice.acrescentadosVarios(chaves, numRegistos);
+	numRegistos = total;
+}
+
+// ============================================================================
+// REMOVER (swap-and-pop)
+// ============================================================================
+// O "buraco" deixado pelo registo apagado e preenchido com o ULTIMO, e o
+// array e realocado com menos uma posicao:
+//
+//   ANTES:   registos -> [ptr0][ptrX][ptr2][ptr3]   (apagar posicao 1)
+//   DEPOIS:  registos -> [ptr0][ptr3][ptr2]
+//
+// So se movem PONTEIROS, nunca objetos.
+// ============================================================================
+template <typename Registo, typename Extrator, template <typename> class Indice>
+void Armario<Registo, Extrator, Indice>::remover(int pos) {
+	int ultimo = numRegistos - 1;
+	indice.removido(chaveDe(*registos[pos]), pos, chaveDe(*registos[ultimo]), ultimo);
+
+	delete registos[pos];
+	registos[pos] = registos[ultimo];
+	numRegistos--;
+
+	Registo** registosTemp = numRegistos > 0 ? new Registo * [numRegistos] : nullptr;
+	for (int j = 0; j < numRegistos; j++) {
+		registosTemp[j] = registos[j];
+	}
+
+	delete[] registos;
+	registos = registosTemp;
+}
+
+// ============================================================================
+// REMOVER MARCADOS
+// ============================================================================
+// Para apagar muitos registos, remover() um a um realocaria o array de cada
+// vez. Aqui os que ficam sao juntos num so array novo, pela mesma ordem, e o
+// indice e refeito de uma vez:
+//
+//   registos -> [ptr0][ptr1][ptr2][ptr3]    marcados -> [0][1][0][1]
+//   registos -> [ptr0][ptr2]
+// ============================================================================
+template <typename Registo, typename Extrator, template <typename> class Indice>
+void Armario<Registo, Extrator, Indice>::removerMarcados(std::span<const char> marcados) {
+	int ficam = 0;
+	for (int i = 0; i < numRegistos; i++) {
+		ficam += marcados[i] == 0;
+	}
+	if (ficam == numRegistos) {
+		return;
+	}
+
+	Registo** registosTemp = ficam > 0 ? new Registo * [ficam] : nullptr;
+	std::vector<Chave> chaves;
+	chaves.reserve(ficam);
+	int j = 0;
+	for (int i = 0; i < numRegistos; i++) {
+		if (marcados[i] != 0) {
+			delete registos[i];
+		}
+		else {
+			registosTemp[j++] = registos[i];
+			chaves.push_back(chaveDe(*registos[i]));
+		}
+	}
+
+	delete[] registos;
+	registos = registosTemp;
+	numRegistos = ficam;
+
+	indice.limpar();
+	indice.acrescentadosVarios(chaves, 0);
+}
+
+// Liberta cada OBJETO e depois o ARRAY de ponteiros; fica como acabado de construir
+template <typename Registo, typename Extrator, template <typename> class Indice>
+void Armario<Registo, Extrator, Indice>::esvaziar() {
+	for (int i = 0; i < numRegistos; i++) {
+		delete registos[i];
+	}
+	delete[] registos;
+
+	registos = nullptr;	// evita dangling pointer
+	numRegistos = 0;
+	indice.limpar();
+}
@@ -1,7 +1,69 @@
 ﻿#include "ArmarioFichas.h"
+#include "GestorEpocas.h"
+#include "OrdenacaoNomes.h"
+#include "../comum/Instrumentacao.h"
+#include <algorithm>
+#include <climits>
+#include <numeric>
+#include <unordered_set>
+#include <utility>
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <xmmintrin.h>
+#define PREFETCH(p) _mm_prefetch((const char*)(p), _MM_HINT_T0)
+#elif defined(__GNUC__)
+#define PREFETCH(p) __builtin_prefetch(p)
+#else
+#define PREFETCH(p) ((void)0)
+#endif
+
+namespace {
+
+	// A linha da listagem de um cliente frio (igual a Cliente::obtemDesc() + '\n')
+	void acrescentarLinhaFria(std::string& texto, const ArmazemFrio::Vista& v) {
+		texto += v.nome;
+		texto += " / ";
+		texto += std::to_string(v.nif);
+		texto += " / ";
+		texto += std::to_string(v.numConsultas);
+		texto += '\n';
+	}
+}
+
+// Construtor do InfoCliente
+ArmarioFichas::InfoCliente::InfoCliente(const std::string& nomeClienteP, int numConsultasP) :
+	nomeCliente(nomeClienteP), numConsultas(numConsultasP) {
+}
 
 // Construtor Default
-ArmarioFichas::ArmarioFichas() : numClientes(0), clientes(nullptr) {}
+ArmarioFichas::ArmarioFichas() : versaoPublicada(nullptr), numVersoes(0), relogio(0), proximaOrdem(0), quentesForaDeOrdem(false), textoFriosValido(false), textoCompletoValido(false) {}
+
+// Construtor a partir de uma versao publicada: os clientes sao acrescentados num so lote
+ArmarioFichas::ArmarioFichas(const VersaoArmario& versao) : ArmarioFichas() {
+	std::vector<RegistoCliente> registos;
+	registos.reserve(versao.getNumClientes());
+	for (const VersaoArmario::Ficha& f : versao.obtemFichas()) {
+		registos.push_back(RegistoCliente{ f.obtemNome(), f.obtemNIF(), f.obtemNumConsultas() });
+	}
+	acrescentarLote(registos);
+}
+
+// Procura pelo NIF (indice do Armario, ver Armario.h): devolve a posicao em 'clientes' ou -1
+// (se o filtro de Bloom disser que o NIF nao existe, nem se procura)
+int ArmarioFichas::posicaoDe(int nif) const {
+	if (!filtroNIF.podeConter(nif)) {
+		return -1;
+	}
+	return clientes.posicaoDe(nif);
+}
+
+// Procura no armazem frio (so se houver frios e o filtro de Bloom nao rejeitar o NIF)
+std::optional<ArmazemFrio::Vista> ArmarioFichas::verFrio(int nif) const {
+	if (frios.getNumRegistos() == 0 || !filtroNIF.podeConter(nif)) {
+		return std::nullopt;
+	}
+	return frios.procurar(nif);
+}
 
 // ============================================================================
 // CONSTRUTOR POR COPIA (Deep Copy)
@@ -19,46 +81,24 @@ ArmarioFichas::ArmarioFichas() : numClientes(0), clientes(nullptr) {}
 //   - Modificar 'a' NAO afeta 'b'
 //   - Destruir 'a' NAO afeta 'b'
 // ============================================================================
-ArmarioFichas::ArmarioFichas(const ArmarioFichas& outra) {
-	// Copiar o numero de clientes (valor simples)
-	numClientes = outra.numClientes;
-	// 'numClientes' e um int, entao e uma copia simples
-
-	// Alocar NOVA memoria para o array de ponteiros
-	clientes = new Cliente * [outra.numClientes]; //ou this->clientes = new Cliente * [outra.numClientes]; é a mesma coisa
-	
-	// 'clientes' (tipo Cliente**) aponta para um NOVO array
-	// Este array tera o MESMO tamanho que o array de 'outra'
-	// MAS e um array DIFERENTE (memoria INDEPENDENTE)
-	//
-	// Visualizacao:
-	//   outra.clientes -> [ptrA][ptrB][ptrC]  (array existente)
-	//                       ↓     ↓     ↓
-	//                    ClienteA ClienteB ClienteC
-	//
-	//   this->clientes -> [   ][   ][   ]  (NOVO array, ainda vazio)
-
-	// Copiar cada Cliente INDIVIDUALMENTE (deep copy)
-	for (int i = 0; i < outra.numClientes; i++) {
-		// Criar NOVO objeto Cliente copiando dados
-		clientes[i] = new Cliente(
-			outra.clientes[i]->obtemNome(),
-			outra.clientes[i]->obtemNIF()
-		);
-		// 'new Cliente(...)' cria um NOVO objeto Cliente na memoria
-		// Com os MESMOS dados do Cliente original (nome, NIF)
-		// MAS e um objeto DIFERENTE (endereco diferente)
-		//
-		// Exemplo: Se outra.clientes[0] esta em 0x1000,
-		//          this->clientes[0] estara em 0x2000 (endereco diferente!)
-
-		// Copiar o numero de consultas (dado adicional)
-		for (int j = 0; j < outra.clientes[i]->obtemNumConsultas(); j++) {
-			clientes[i]->novaConsulta();
-			// Como Cliente nao tem um setter para numConsultas,
-			// chamamos novaConsulta() repetidamente para igualar o contador numConsultas
-		}
+ArmarioFichas::ArmarioFichas(const ArmarioFichas& outra) : clientes(outra.clientes), cacheListagem(outra.cacheListagem), indiceConsultas(outra.indiceConsultas), indiceNomes(outra.indiceNomes),
+	versaoPublicada(nullptr), numVersoes(0), alteracoes(outra.alteracoes.getSequencia()),
+	frios(outra.frios), ultimaAtividade(outra.ultimaAtividade), relogio(outra.relogio),
+	ordemListagem(outra.ordemListagem), proximaOrdem(outra.proximaOrdem), quentesForaDeOrdem(outra.quentesForaDeOrdem), textoFriosValido(false), textoCompletoValido(false) {
+	// 'clientes' ja foi copiado na lista de inicializacao (deep copy, ver Armario.h):
+	// um array NOVO, com um objeto Cliente NOVO por cada Cliente de 'outra'
+	// (mesmo nome, NIF e numero de consultas, mas endereco diferente)
+
+	// Filtro de Bloom: reconstruido so com os NIFs que existem (sem os apagados de 'outra')
+	if (outra.filtroNIF.ativo()) {
+		reconstruirFiltroNIF();
 	}
+	// A ordem por NIF aponta para Clientes: tem de apontar para as copias, nao para os de 'outra'
+	if (outra.ordemNIF.estaAtiva()) {
+		preencherOrdemNIF(ordemNIF);
+	}
+	// O registo de alteracoes comeca vazio, mas ativo se o de 'outra' estiver
+	alteracoes.ativar(outra.alteracoes.estaAtivo());
 
 	// Visualizacao FINAL:
 	//   outra.clientes -> [ptrA][ptrB][ptrC]  (array original)
@@ -110,52 +150,41 @@ ArmarioFichas& ArmarioFichas::operator=(const ArmarioFichas& outra) {
 		// 'this' = ponteiro para o objeto
 	}
 
-	// Libertar TODOS os objetos Cliente do array atual
-	for (int i = 0; i < numClientes; i++) {
-		delete clientes[i];
-		// 'clientes[i]' e um ponteiro (tipo Cliente*), que guarda o endereço de um Cliente
-		// 'delete' liberta o OBJETO Cliente apontado, ou seja destruímos o objeto Cliente em [i], ao libertarmos a memória dela
-	}
-	// Visualizacao:
-	//   this->clientes -> [ptr0][ptr1][ptr2]
-	//                       X     X     X
-	//                       ✗     ✗     ✗  (objetos Cliente destruidos!)
-
-	// Libertar o ARRAY de ponteiros tipo (Cliente*) antigo
-	delete[] clientes;
-	// Liberta apenas o ARRAY em si (os ponteiros do tipo Cliente*)
-	// Os objetos ja foram libertados em cima
-	//
-	// Visualizacao:
-	//   this->clientes -> [LIBERTADO]  (array antigo destruido)
-
-	// Copiar o numero de clientes (valor simples)
-	numClientes = outra.numClientes;
+	// Libertar os Clientes antigos e copiar os de 'outra' (deep copy, ver Armario.h):
+	//   1) Cada objeto Cliente antigo e destruido, depois o array de ponteiros
+	//   2) Um array NOVO recebe um Cliente NOVO por cada Cliente de 'outra'
+	clientes = outra.clientes;
 
-	// Alocar NOVA memoria para o array de ponteiros do tipo Cliente*
-	clientes = new Cliente * [outra.numClientes];
-	// Cria um NOVO array com o tamanho de 'outra, o objeto da direita'
-	//
-	// Visualizacao:
-	//   outra.clientes -> [ptrA][ptrB][ptrC]  (array de 'outra')
-	//                       ↓     ↓     ↓
-	//                    ClienteA ClienteB ClienteC
-	//
-	//   this->clientes -> [   ][   ][   ]  (NOVO array vazio)
-
-	// Copiar cada Cliente INDIVIDUALMENTE (deep copy)
-	for (int i = 0; i < outra.numClientes; i++) {
-		// Criar NOVO objeto Cliente copiando dados
-		clientes[i] = new Cliente(
-			outra.clientes[i]->obtemNome(),
-			outra.clientes[i]->obtemNIF()
-		);
-		// Cria NOVO objeto com os mesmos dados
-
-		// Copiar numero de consultas
-		for (int j = 0; j < outra.clientes[i]->obtemNumConsultas(); j++) {
-			clientes[i]->novaConsulta();
-		}
+	// A cache da listagem tem as mesmas linhas, pela mesma ordem
+	cacheListagem = outra.cacheListagem;
+	// O indice por consultas tem os mesmos NIFs nos mesmos baldes
+	indiceConsultas = outra.indiceConsultas;
+	indiceNomes = outra.indiceNomes;
+	// As sequencias continuam a partir das de 'outra' (uma copia e uma replica atualizada)
+	alteracoes.recomecar(outra.alteracoes.getSequencia());
+	alteracoes.ativar(outra.alteracoes.estaAtivo());
+	// Os clientes frios (ja comprimidos) e a atividade de cada cliente quente
+	frios = outra.frios;
+	ultimaAtividade = outra.ultimaAtividade;
+	relogio = outra.relogio;
+	ordemListagem = outra.ordemListagem;
+	proximaOrdem = outra.proximaOrdem;
+	quentesForaDeOrdem = outra.quentesForaDeOrdem;
+	textoFriosValido = false;
+	textoCompletoValido = false;
+	// O filtro de Bloom e reconstruido so com os NIFs que existem
+	if (outra.filtroNIF.ativo()) {
+		reconstruirFiltroNIF();
+	}
+	else {
+		filtroNIF.dimensionar(0);
+	}
+	// A ordem por NIF passa a apontar para os Clientes novos
+	if (outra.ordemNIF.estaAtiva()) {
+		preencherOrdemNIF(ordemNIF);
+	}
+	else {
+		ordemNIF.ativar(false);
 	}
 
 	// Visualizacao FINAL:
@@ -182,256 +211,201 @@ ArmarioFichas& ArmarioFichas::operator=(const ArmarioFichas& outra) {
 
 // Destrutor
 ArmarioFichas::~ArmarioFichas() {
-	// Liberta cada OBJETO Cliente individualmente
-	for (int i = 0; i < numClientes; i++) {
-		delete clientes[i];
-		// 'clientes[i]' e um PONTEIRO para Cliente (tipo Cliente*)
-		// 'delete clientes[i]' liberta a MEMORIA do OBJETO Cliente apontado, ou seja liberta a memória alocada para o objeto Cliente na posição [i]
-		// Exemplo: Se clientes[0] aponta para endereco 0x1000,
-		//          delete liberta a memória alocada para o objeto Cliente que esta em 0x1000
-	}
-
-	// Liberta o ARRAY de ponteiros para Cliente (tipo Cliente*)
-	delete[] clientes;
-	// 'clientes' e um PONTEIRO para ponteiro (tipo Cliente**)
-	// Aponta para um ARRAY de ponteiros (cada elemento e do tipo Cliente*), ou seja, em cada posição do array guarda o endereço de um objeto Cliente.
-	// 'delete[] clientes' liberta apenas o ARRAY em si, NAO os objetos
-	// (os objetos ja foram libertados em cima)
-	//
-	// Visualizacao:
-	// ANTES:
-	//   clientes -> [ptr0][ptr1][ptr2]  <- Array de ponteiros (sera libertado aqui)
-	//                 |     |     |
-	//                 v     v     v
-	//             Cliente Cliente Cliente  <- Objetos (ja libertados em cima, dentro do ciclo for)
-	//				  x       x       x 
-	// DEPOIS:
-	//   Toda a memoria alocada foi libertada
+	// Os objetos Cliente e o array de ponteiros sao libertados pelo destrutor
+	// de 'clientes' (Armario::esvaziar): primeiro cada objeto, depois o array
+
+	// A versao publicada pode ainda estar a ser lida noutra thread:
+	// e entregue ao gestor de epocas, que a apaga quando for seguro
+	const VersaoArmario* versao = versaoPublicada.load();
+	if (versao != nullptr) {
+		GestorEpocas::global().retirar(versao);
+	}
 }
 
 bool ArmarioFichas::acrescentarClientes(const std::string& nome, int nif) {
+	MEDIR("ArmarioFichas::acrescentarClientes");
+
 	// Verificar se ja existe cliente com o mesmo NIF
-	for (int i = 0; i < numClientes; i++) {
-		if (clientes[i]->obtemNIF() == nif) {
-			return false;  // NIF duplicado, nao acrescenta
-		}
+	// (com o filtro de Bloom ativo, um NIF novo normalmente nem chega a ser procurado)
+	if (posicaoDe(nif) >= 0 || verFrio(nif)) {
+		return false;  // NIF duplicado (quente ou frio), nao acrescenta
 	}
 
-	// Criar ARRAY TEMPORARIO de ponteiros com tamanho aumentado
-	Cliente** clientesTemp = new Cliente * [numClientes + 1];
-	// 'clientesTemp' e um PONTEIRO para ponteiro (tipo Cliente**)
-	// Aponta para um NOVO array com (numClientes + 1) posicoes
-	// Cada posicao do array e do tipo Cliente* (ponteiro para Cliente), cada posição [i] guarda o endereço de um objeto Cliente
-	//
-	// Visualizacao:
-	//   clientesTemp -> [   ][   ][   ][   ]  <- Array com 4 posicoes (se era numClientes=3)
-	//                   Cada posicao guardara um Cliente* (ponteiro para Cliente)
-
-	// Copiar PONTEIROS para Cliente (Cliente*)/endereço do Cliente do array antigo para o novo array (clientesTemp)
-	for (int i = 0; i < numClientes; i++) {
-		clientesTemp[i] = clientes[i];
-		// NAO estamos a copiar OBJETOS Cliente!
-		// Estamos a copiar PONTEIROS (enderecos de memoria)
-		// Exemplo: Se clientes[0] contem 0x1000, agora clientesTemp[0] tambem contem 0x1000
-		//          Ambos apontam para o MESMO objeto Cliente
-	}
-
-	// Criar NOVO objeto Cliente na ultima posicao do array novo (clientesTemp)
-	clientesTemp[numClientes] = new Cliente(nome, nif);
-	// 'new Cliente(nome, nif)' cria um NOVO objeto Cliente na memoria
-	// Retorna um PONTEIRO para esse objeto (tipo Cliente*)
-	// Esse ponteiro e guardado em clientesTemp[numClientes]
+	// Criar o NOVO Cliente no fim do array (o Armario fica dono do objeto):
+	// array novo com mais uma posicao, copia dos PONTEIROS, novo Cliente na
+	// ultima posicao (ver Armario::acrescentar)
+	clientes.acrescentar(new Cliente(nome, nif));
 	//
 	// Visualizacao:
-	//   clientesTemp -> [ptr0][ptr1][ptr2][ptrNovo]
-	//                     |     |     |       |
-	//                     v     v     v       v
-	//                 Cliente Cliente Cliente NovoCliente <- Criado aqui!
-
-	// Libertar o ARRAY de ponteiros para Cliente antigo
-	delete[] clientes;
-	// O que acontece aqui:
-	// 1) Liberta a MEMORIA do ARRAY em si (os "slots" onde estavam os ponteiros)
-	// 2) Os PONTEIROS (Cliente*) sao destruidos (os enderecos deixam de existir)
-	// 3) MAS os OBJETOS Cliente NAO sao destruidos! Continuam na memoria!
-	//
-	// Por que os objetos continuam a existir?
-	// - Porque 'clientesTemp' AINDA aponta para eles!
-	// - Temos duas variaveis a apontar para os mesmos objetos
-	// - Destruir uma das variaveis NAO destroi os objetos
-	//
-	// Analogia:
-	//   Array 'clientes' = Lista A de moradas
-	//   Array 'clientesTemp' = Lista B de moradas (mesmas moradas!)
-	//   delete[] clientes; → Destroi Lista A
-	//   Mas as casas ainda existem porque Lista B ainda as referencia!
-	//
-	// Visualizacao:
-	//   ANTES:
-	//     clientes -> [ptr0][ptr1][ptr2]  (Lista A)
-	//                   ↓     ↓     ↓
-	//     clientesTemp -> [ptr0][ptr1][ptr2][ptrNovo]  (Lista B)
-	//                   ↓     ↓     ↓       ↓
-	//                 Cliente Cliente Cliente NovoCliente
-	//
-	//   DEPOIS de delete[] clientes:
-	//     clientes -> [DESTRUÍDO]  (Lista A foi destruida)
-	//     
-	//     clientesTemp -> [ptr0][ptr1][ptr2][ptrNovo]  (Lista B ainda existe!)
-	//                       ↓     ↓     ↓       ↓
-	//                   Cliente Cliente Cliente NovoCliente (objetos INTACTOS!)
-
-	// Fazer 'clientes' apontar para o array novo
-	clientes = clientesTemp;
-	// Agora 'clientes' aponta para o mesmo array que 'clientesTemp'
-	// 'clientesTemp' e apenas uma variavel local (sera destruida no fim da funcao)
-	// mas o array que ela aponta continuara a existir atraves de 'clientes'
-	//
-	// Visualizacao:
-	//   clientes -------> [ptr0][ptr1][ptr2][ptrNovo]
-	//   clientesTemp ---> (aponta para o mesmo lugar)
+	//   clientes -> [ptr0][ptr1][ptr2][ptrNovo]
+	//                 |     |     |       |
+	//                 v     v     v       v
+	//             Cliente Cliente Cliente NovoCliente <- Criado aqui!
+	const Cliente* novo = clientes[clientes.getNumRegistos() - 1];
+
+	// Nova ranhura no fim da cache da listagem (mesma posicao que o novo cliente)
+	cacheListagem.acrescentar(novo->obtemDesc() + '\n', (int)nome.size());
+	// Novo cliente entra no balde das 0 consultas
+	indiceConsultas.acrescentar(nif);
+	// E fica na posicao do seu nome no indice por nome
+	indiceNomes.acrescentar(nome, nif);
+	// Nova entrada no registo de alteracoes (para as replicas)
+	alteracoes.acrescentado(nome, nif, 0);
+	ultimaAtividade.push_back(++relogio);
+	ordemListagem.push_back(proximaOrdem++);	// ultimo da listagem
+	textoCompletoValido = false;
 
-	// Incrementar o contador de clientes
-	numClientes++;
-	// Agora numClientes = 4 (se era 3 antes)
+	// Filtro de Bloom (se ativo): acrescentar o NIF, ou reconstruir se ja esta cheio
+	if (filtroNIF.ativo()) {
+		if (filtroNIF.cheio()) {
+			reconstruirFiltroNIF();
+		}
+		else {
+			filtroNIF.acrescentar(nif);
+		}
+	}
+	// Ordem por NIF (se ativa): fica pendente ate a proxima listagemPorNIF/nifsEntre
+	if (ordemNIF.estaAtiva()) {
+		ordemNIF.acrescentar(novo);
+	}
 
 	return true;
 }
 
+// ============================================================================
+// ACRESCENTAR LOTE
+// ============================================================================
+// Acrescenta muitos clientes de uma so vez (ex: importacao de um ficheiro).
+// Chamar acrescentarClientes por cada um custaria O(n) por cliente (procura
+// de duplicados + novo array com mais uma posicao), O(n^2) no total.
+// Aqui:
+//   1) Os duplicados (ja existentes OU repetidos no lote) sao detetados com
+//      uma tabela de hash, O(n + m)
+//   2) O array 'clientes' e realocado UMA vez, ja com o tamanho final
+//   3) Os indices sao atualizados em bloco
+//
+// Se um NIF aparece varias vezes no lote, fica o primeiro registo.
+// Registos com consultas fora de 0..MAX_CONSULTAS sao rejeitados (as
+// consultas sao repetidas uma a uma, e a replica nao as aceitaria).
+//
+// Retorno: numero de registos rejeitados (NIF duplicado ou consultas fora do limite)
+// ============================================================================
+int ArmarioFichas::acrescentarLote(std::span<const RegistoCliente> registos) {
+	MEDIR("ArmarioFichas::acrescentarLote");
+
+	// 1) Escolher os registos a acrescentar
+	std::unordered_set<int> nifsVistos;
+	nifsVistos.reserve(getNumClientes() + registos.size());
+	for (int i = 0; i < clientes.getNumRegistos(); i++) {
+		nifsVistos.insert(clientes[i]->obtemNIF());
+	}
+	frios.paraCada([&](const ArmazemFrio::Vista& v) { nifsVistos.insert(v.nif); });
+
+	std::vector<int> aceites;	// indices (em 'registos') dos registos a acrescentar
+	aceites.reserve(registos.size());
+	for (int j = 0; j < (int)registos.size(); j++) {
+		if (registos[j].numConsultas < 0 || registos[j].numConsultas > MAX_CONSULTAS) {
+			continue;
+		}
+		if (nifsVistos.insert(registos[j].nif).second) {
+			aceites.push_back(j);
+		}
+	}
+
+	if (aceites.empty()) {
+		return (int)registos.size();
+	}
+
+	// 2) Os Clientes novos entram todos de uma vez, num so array novo (Armario::acrescentarVarios)
+	std::vector<Cliente*> novos;
+	novos.reserve(aceites.size());
+
+	std::vector<std::pair<std::string, int>> novosNomes;
+	novosNomes.reserve(aceites.size());
+
+	for (int k = 0; k < (int)aceites.size(); k++) {
+		const RegistoCliente& r = registos[aceites[k]];
+		Cliente* novo = new Cliente(std::string(r.nome), r.nif);
+
+		// Cliente nao tem setter para numConsultas: novaConsulta() repetido ate igualar
+		for (int c = 0; c < r.numConsultas; c++) {
+			novo->novaConsulta();
+		}
+		novos.push_back(novo);
+
+		// 3) Indices
+		cacheListagem.acrescentar(novo->obtemDesc() + '\n', (int)r.nome.size());
+		indiceConsultas.acrescentar(r.nif, novo->obtemNumConsultas());
+		novosNomes.emplace_back(std::string(r.nome), r.nif);
+		alteracoes.acrescentado(r.nome, r.nif, novo->obtemNumConsultas());
+		ultimaAtividade.push_back(++relogio);
+		ordemListagem.push_back(proximaOrdem++);
+	}
+	indiceNomes.acrescentarVarios(std::move(novosNomes));
+
+	clientes.acrescentarVarios(novos);
+	textoCompletoValido = false;
+
+	if (filtroNIF.ativo()) {
+		reconstruirFiltroNIF();
+	}
+	if (ordemNIF.estaAtiva()) {
+		ordemNIF.acrescentarVarios(novos);
+	}
+
+	return (int)(registos.size() - aceites.size());
+}
+
 bool ArmarioFichas::apagarCliente(int nif) {
+	MEDIR("ArmarioFichas::apagarCliente");
+
 	// Procurar o cliente com o NIF especificado
-	for (int i = 0; i < numClientes; i++) {
-		if (clientes[i]->obtemNIF() == nif) {
-			// Cliente encontrado na posicao 'i'!
-
-			// Libertar a MEMORIA do OBJETO Cliente encontrado
-			delete clientes[i];
-			// 'clientes[i]' e um PONTEIRO para Cliente (tipo Cliente*)
-			// 'delete clientes[i]' liberta a memória alocada para o OBJETO Cliente apontado
-			// Exemplo: Se clientes[2] apontava para 0x5000, o objeto em 0x5000 e destruido e a memória alocada libertada
-			//
-			// Visualizacao:
-			//   clientes -> [ptr0][ptr1][ptr2][ptr3]
-			//                 ↓     ↓     X     ↓
-			//             Cliente Cliente ✗ Cliente  <- Objeto em ptr2 foi destruido!
-
-			// Preencher o "buraco" com o ULTIMO elemento (swap-and-pop)
-			clientes[i] = clientes[numClientes - 1];
-			// Move o PONTEIRO (tipo Cliente*) do ultimo elemento para a posicao do elemento apagado
-			// NAO move o objeto, apenas o PONTEIRO do tipo Cliente*! 
-			// Isto evita deixar "buracos" (nullptr) no meio do array
-			//
-			// Exemplo: Se i=1 e numClientes=4:
-			//   clientes[1] = clientes[3];
-			//   Copia o ponteiro da posicao 3 para a posicao 1
-			//
-			// Visualizacao ANTES:
-			//   clientes -> [ptr0][ptrX][ptr2][ptr3]  <- ptrX foi libertado (X no objeto)
-			//                 ↓     X     ↓     ↓
-			//             Cliente  ✗  Cliente Cliente
-			//
-			// Visualizacao DEPOIS:
-			//   clientes -> [ptr0][ptr3][ptr2][ptr3]  <- ptr3 agora aparece 2 vezes!
-			//                 ↓     ↓     ↓     ↓
-			//             Cliente Cliente Cliente Cliente
-			//                      (copiado)      (original)
-
-			// Diminuir o contador de clientes
-			numClientes--;
-			// Agora numClientes = 3 (era 4)
-			// Logicamente "esconde" o ultimo elemento (que foi movido para cima)
-			//
-			// Visualizacao LOGICA:
-			//   clientes -> [ptr0][ptr3][ptr2]|[ptr3]  <- Elemento depois de | e ignorado
-			//                 ↓     ↓     ↓    |
-			//             Cliente Cliente Cliente|     <- Ultimo nao e mais usado
-			//                                    |
-			//                      (fronteira: numClientes=3)
-
-			// Criar ARRAY TEMPORARIO com tamanho REDUZIDO por causa do (numClientes--)
-			Cliente** clientesTemp = new Cliente * [numClientes];
-			// 'clientesTemp' e um PONTEIRO para ponteiro (tipo Cliente**)
-			// Aponta para um NOVO array menor: tamanho = numClientes (ja decrementado!)
-			// Exemplo: Se numClientes=4 antes agora numClientes=3, cria array com 3 posicoes
-			//
-			// Visualizacao:
-			//   clientesTemp -> [   ][   ][   ]  <- Array com 3 posicoes
-
-			// Copiar PONTEIROS do array antigo para o novo (apenas elementos validos)
-			for (int j = 0; j < numClientes; j++) {
-				clientesTemp[j] = clientes[j];
-				// Copia apenas os primeiros 'numClientes' ponteiros
-				// NAO copia o ponteiro duplicado no final!
-				// NAO copia OBJETOS, apenas PONTEIROS do tipo Cliente* (que guarda enderecos do objeto Cliente)
-			}
-			// Visualizacao:
-			//   Array ANTIGO:
-			//     clientes -> [ptr0][ptr3][ptr2][ptr3]  <- 4 posicoes, ultima e duplicada
-			//                   ↓     ↓     ↓     ↓
-			//               Cliente Cliente Cliente Cliente
-			//
-			//   Array NOVO:
-			//     clientesTemp -> [ptr0][ptr3][ptr2]  <- 3 posicoes, SEM duplicacao!
-			//                       ↓     ↓     ↓
-			//                   Cliente Cliente Cliente
-
-			// Libertar o ARRAY de ponteiros antigo
-			delete[] clientes;
-			// O que acontece aqui:
-			// 1) Liberta a MEMORIA do ARRAY em si (os "slots" onde estavam os ponteiros)
-			// 2) Os PONTEIROS (Cliente*) sao destruidos (os enderecos deixam de existir)
-			// 3) MAS os OBJETOS Cliente NAO sao destruidos! Continuam na memoria!
-			//
-			// Por que os objetos continuam a existir?
-			// - Porque 'clientesTemp' AINDA aponta para eles!
-			// - Temos duas variaveis a apontar para os mesmos objetos
-			// - Destruir uma das variaveis NAO destroi os objetos
-			//
-			// Analogia:
-			//   Array 'clientes' = Lista A de moradas
-			//   Array 'clientesTemp' = Lista B de moradas (mesmas moradas!)
-			//   delete[] clientes; → Destroi Lista A
-			//   Mas as casas ainda existem porque Lista B ainda as referencia!
-			//
-			// Visualizacao:
-			//   ANTES:
-			//     clientes -> [ptr0][ptr1][ptr2]  (Lista A)
-			//                   ↓     ↓     ↓
-			//     clientesTemp -> [ptr0][ptr1][ptr2][ptrNovo]  (Lista B)
-			//                   ↓     ↓     ↓       ↓
-			//                 Cliente Cliente Cliente NovoCliente
-			//
-			//   DEPOIS de delete[] clientes:
-			//     clientes -> [DESTRUÍDO]  (Lista A foi destruida)
-			//     
-			//     clientesTemp -> [ptr0][ptr1][ptr2][ptrNovo]  (Lista B ainda existe!)
-			//                       ↓     ↓     ↓       ↓
-			//                   Cliente Cliente Cliente NovoCliente (objetos INTACTOS!)
-
-			// Fazer 'clientes' apontar para o array novo
-			clientes = clientesTemp;
-			// Agora 'clientes' aponta para o mesmo array que 'clientesTemp'
-			// 'clientesTemp' e apenas uma variavel local (sera destruida no fim da funcao)
-			// mas o array que ela aponta continuara a existir atraves de 'clientes'
-			//
-			// Visualizacao:
-			//   clientes -------> [ptr0][ptr3][ptr2]
-			//   clientesTemp ---> (aponta para o mesmo lugar)
-			//                       ↓     ↓     ↓
-			//                   Cliente Cliente Cliente
-
-			return true;  // Cliente apagado com sucesso!
-
-			// RESUMO DO QUE ACONTECEU:
-			// - Objeto Cliente destruido (delete clientes[i])
-			// - "Buraco" preenchido com ultimo elemento (swap-and-pop)
-			// - Array redimensionado de 4 para 3 posicoes
-			// - numClientes decrementado de 4 para 3
+	// (o filtro de Bloom rejeita logo um NIF que de certeza nao existe)
+	int i = posicaoDe(nif);
+	if (i < 0) {
+		// Cliente frio: sai do armazem frio e dos indices (que tambem tem os frios)
+		ArmazemFrio::Registo frio;
+		if (frios.getNumRegistos() == 0 || !filtroNIF.podeConter(nif) || !frios.retirar(nif, frio)) {
+			return false;  // Cliente nao encontrado
 		}
+		indiceNomes.remover(frio.nome, nif);
+		indiceConsultas.remover(nif);
+		alteracoes.apagado(nif);
+		textoFriosValido = false;
+		textoCompletoValido = false;
+		return true;
 	}
 
-	// Cliente nao encontrado
-	return false;
+	// Tirar do indice por nome ANTES de destruir o objeto (ainda precisamos do nome)
+	indiceNomes.remover(clientes[i]->obtemNome(), nif);
+	alteracoes.apagado(nif);
+
+	// A cache da listagem faz o mesmo swap-and-pop que 'clientes' nas suas ranhuras
+	cacheListagem.remover(i);
+	indiceConsultas.remover(nif);
+	if (ordemNIF.estaAtiva()) {
+		ordemNIF.remover(nif);
+	}
+
+	// Destruir o objeto Cliente e preencher o "buraco" com o ULTIMO (swap-and-pop),
+	// num array com menos uma posicao (ver Armario::remover)
+	clientes.remover(i);
+	ultimaAtividade[i] = ultimaAtividade.back();
+	ultimaAtividade.pop_back();
+	// O ultimo fica com o lugar do apagado na listagem (como na cache da listagem)
+	ordemListagem.pop_back();
+	textoCompletoValido = false;
+	//
+	// Visualizacao (apagar a posicao 1 de 4):
+	//   ANTES:   clientes -> [ptr0][ptrX][ptr2][ptr3]
+	//                          ↓     X     ↓     ↓
+	//                      Cliente  ✗  Cliente Cliente
+	//
+	//   DEPOIS:  clientes -> [ptr0][ptr3][ptr2]  <- 3 posicoes, ptr3 mudou de sitio
+	//                          ↓     ↓     ↓
+	//                      Cliente Cliente Cliente
+
+	return true;  // Cliente apagado com sucesso!
 }
 
 // ============================================================================
@@ -453,27 +427,35 @@ bool ArmarioFichas::apagarCliente(int nif) {
 //   - false: Cliente nao encontrado (NIF nao existe no armario)
 // ============================================================================
 bool ArmarioFichas::registarConsulta(int nif) {
-	// Percorrer todos os clientes do armario
-	for (int i = 0; i < numClientes; i++) {
-		// Verificar se o cliente na posicao 'i' tem o NIF procurado
-		if (clientes[i]->obtemNIF() == nif) {
-			// Cliente encontrado!
-			// 'clientes[i]' e um ponteiro (tipo Cliente*)
-			// '->' e usado para aceder a metodos do objeto apontado
-
-			// Incrementar o contador de consultas do cliente
-			clientes[i]->novaConsulta();
-			// Chama o metodo 'novaConsulta()' do objeto Cliente
-			// Este metodo incrementa o contador interno 'numConsultas'
-			//
-			// Exemplo: Se o cliente tinha 5 consultas, agora tem 6
-
-			return true;  // Sucesso! Consulta registada
-		}
+	MEDIR("ArmarioFichas::registarConsulta");
+
+	// Procurar o cliente pelo NIF (o filtro de Bloom rejeita logo um NIF que de certeza nao existe)
+	// Um cliente frio volta a ser quente (fica no fim de 'clientes')
+	int i = posicaoDe(nif);
+	if (i < 0) {
+		i = promover(nif);
 	}
+	if (i < 0) {
+		return false;  // Cliente nao encontrado
+	}
+
+	// Incrementar o contador de consultas do cliente
+	clientes[i]->novaConsulta();
+	// 'clientes[i]' e um ponteiro (tipo Cliente*)
+	// Chama o metodo 'novaConsulta()' do objeto Cliente
+	// Este metodo incrementa o contador interno 'numConsultas'
+	//
+	// Exemplo: Se o cliente tinha 5 consultas, agora tem 6
 
-	// Se chegou aqui, percorreu todo o array e nao encontrou o NIF
-	return false;  // Cliente nao encontrado
+	// Apenas a linha deste cliente e reformatada na cache da listagem
+	cacheListagem.atualizar(i, clientes[i]->obtemDesc() + '\n');
+	// E o NIF passa para o balde seguinte do indice por consultas
+	indiceConsultas.incrementar(nif);
+	alteracoes.consulta(nif);
+	ultimaAtividade[i] = ++relogio;
+	textoCompletoValido = false;
+
+	return true;  // Sucesso! Consulta registada
 
 	// Visualizacao do processo:
 	//   clientes -> [Cliente0][Cliente1][Cliente2]
@@ -503,6 +485,10 @@ bool ArmarioFichas::registarConsulta(int nif) {
 //   - InfoCliente com nome e numConsultas (se cliente encontrado)
 //   - InfoCliente("", 0) se cliente nao encontrado (dados vazios)
 //
+// Um cliente frio volta a ser quente, tal como em registarConsulta (ver
+// arrefecer). Num armario const nao se pode promover: a versao const le o
+// cliente frio diretamente do armazem frio.
+//
 // Exemplo de uso:
 //   ArmarioFichas armario;
 //   armario.acrescentarClientes("Maria", 987654321);
@@ -511,19 +497,39 @@ bool ArmarioFichas::registarConsulta(int nif) {
 //   auto dados = armario.obterDados(987654321);
 //   // dados.nome = "Maria", dados.numConsultas = 1
 // ============================================================================
+ArmarioFichas::InfoCliente ArmarioFichas::obterDados(int nif) {
+	MEDIR("ArmarioFichas::obterDados");
+
+	// Um cliente frio volta a ser quente (fica no fim de 'clientes')
+	int i = posicaoDe(nif);
+	if (i < 0) {
+		i = promover(nif);
+	}
+	if (i < 0) {
+		return InfoCliente("", 0);  // Cliente nao encontrado
+	}
+	return InfoCliente(clientes[i]->obtemNome(), clientes[i]->obtemNumConsultas());
+}
+
 ArmarioFichas::InfoCliente ArmarioFichas::obterDados(int nif) const {
-	// Percorrer todos os clientes do armario
-	for (int i = 0; i < numClientes; i++) {
-		// Verificar se o cliente tem o NIF procurado
-		if (clientes[i]->obtemNIF() == nif) {
-			// Cliente encontrado! Retornar os seus dados
-			return InfoCliente(
-				clientes[i]->obtemNome(),           // Nome do cliente
-				clientes[i]->obtemNumConsultas()    // Numero de consultas
-			); // Ele ao retornar está a construir um objeto InfoCliente com os parâmetros daquele clientes[i]
-			// InfoCliente e uma classe que agrupa nome e numConsultas
-			// Definida dentro da classe ArmarioFichas (nested class)
-		}
+	MEDIR("ArmarioFichas::obterDados");
+
+	// Procurar o cliente pelo NIF (o filtro de Bloom rejeita logo um NIF que de certeza nao existe)
+	int i = posicaoDe(nif);
+	if (i >= 0) {
+		// Cliente encontrado! Retornar os seus dados
+		return InfoCliente(
+			clientes[i]->obtemNome(),           // Nome do cliente
+			clientes[i]->obtemNumConsultas()    // Numero de consultas
+		); // Ele ao retornar está a construir um objeto InfoCliente com os parâmetros daquele clientes[i]
+		// InfoCliente e uma classe que agrupa nome e numConsultas
+		// Definida dentro da classe ArmarioFichas (nested class)
+	}
+
+	// Cliente frio: lido do armazem frio, sem o voltar a por em 'clientes'
+	std::optional<ArmazemFrio::Vista> frio = verFrio(nif);
+	if (frio) {
+		return InfoCliente(std::string(frio->nome), frio->numConsultas);
 	}
 
 	// Cliente nao encontrado - retornar dados VAZIOS
@@ -542,6 +548,630 @@ ArmarioFichas::InfoCliente ArmarioFichas::obterDados(int nif) const {
 	//     - Nao encontrado, retorna InfoCliente("", 0)
 }
 
+// ============================================================================
+// VER DADOS
+// ============================================================================
+// Igual a obterDados, mas SEM copias do nome:
+//   - O nome e uma std::string_view para a linha do cliente na cache da
+//     listagem (que comeca sempre pelo nome), por isso nao ha alocacao
+//   - Cliente inexistente devolve um optional vazio, em vez do ambiguo ("", 0)
+//   - Tal como obterDados, promove um cliente frio; a versao const nao o
+//     promove e o nome aponta para dentro do bloco do armazem frio
+//
+// Exemplo de uso:
+//   auto dados = armario.verDados(987654321);
+//   if (dados) {
+//       cout << dados->getNomeCliente() << " " << dados->getNumConsultas();
+//   }
+//
+// IMPORTANTE: a vista so e valida ate a proxima alteracao do armario ou ate
+// a proxima listagem()/verListagem() (que pode juntar de novo o texto onde o
+// nome esta).
+// ============================================================================
+std::optional<ArmarioFichas::VistaCliente> ArmarioFichas::verDados(int nif) {
+	MEDIR("ArmarioFichas::verDados");
+
+	int i = posicaoDe(nif);
+	if (i < 0) {
+		i = promover(nif);
+	}
+	if (i < 0) {
+		return std::nullopt;
+	}
+	return VistaCliente(cacheListagem.nome(i), clientes[i]->obtemNumConsultas());
+}
+
+std::optional<ArmarioFichas::VistaCliente> ArmarioFichas::verDados(int nif) const {
+	MEDIR("ArmarioFichas::verDados");
+
+	int i = posicaoDe(nif);
+	if (i < 0) {
+		// Cliente frio: o nome aponta para dentro do bloco do armazem frio
+		std::optional<ArmazemFrio::Vista> frio = verFrio(nif);
+		if (frio) {
+			return VistaCliente(frio->nome, frio->numConsultas);
+		}
+		return std::nullopt;
+	}
+	return VistaCliente(cacheListagem.nome(i), clientes[i]->obtemNumConsultas());
+}
+
+// ============================================================================
+// OBTER DADOS (em lote)
+// ============================================================================
+// Procura varios NIFs com UMA so passagem pelo array 'clientes', em vez de uma
+// procura linear por cada NIF:
+//
+//   nifs -> [222][999][111]        pedidos: [ (111,2) (222,0) (999,1) ]  (ordenados por NIF)
+//
+//   clientes -> [Cliente0][Cliente1][Cliente2]
+//                NIF:111   NIF:222   NIF:333
+//     - i=0: 111 foi pedido na posicao 2 -> resultados[2]
+//     - i=1: 222 foi pedido na posicao 0 -> resultados[0]
+//     - i=2: 333 nao foi pedido
+//   (cada cliente e procurado em 'pedidos' com uma pesquisa binaria)
+//
+//   resultados -> [Maria][vazio][Joao]
+//
+// Cada Cliente esta num sitio diferente da memoria, por isso enquanto se
+// compara o cliente i ja se pede ao processador o cliente i + DISTANCIA
+// (prefetch), escondendo a latencia de ir buscar cada objeto.
+//
+// As unicas alocacoes sao as do lote (resultados + um vector de pedidos,
+// contiguo e reservado de uma vez), nunca uma por NIF pedido ou procurado.
+//
+// Com INDICE_NIF_DIRETO cada procura por NIF ja e O(1), por isso o lote faz
+// so as k procuras (O(k)) em vez de percorrer os n clientes (O(n)).
+//
+// Os clientes frios pedidos voltam a ser quentes todos de uma vez (um so
+// array novo em 'clientes') e depois a procura e a mesma que num armario
+// const, que le os frios do armazem frio sem os promover.
+// ============================================================================
+std::vector<std::optional<ArmarioFichas::VistaCliente>> ArmarioFichas::obterDados(std::span<const int> nifs) {
+	promoverVarios(nifs);
+	return std::as_const(*this).obterDados(nifs);
+}
+
+std::vector<std::optional<ArmarioFichas::VistaCliente>> ArmarioFichas::obterDados(std::span<const int> nifs) const {
+	MEDIR("ArmarioFichas::obterDados[lote]");
+
+#ifdef INDICE_NIF_DIRETO
+	std::vector<std::optional<VistaCliente>> resultados;
+	resultados.reserve(nifs.size());
+	for (int nif : nifs) {
+		resultados.push_back(verDados(nif));
+	}
+	return resultados;
+#else
+	const int DISTANCIA = 8;
+
+	std::vector<std::optional<VistaCliente>> resultados(nifs.size());
+
+	// (NIF, posicao no lote do primeiro pedido desse NIF), ordenados por NIF
+	std::vector<std::pair<int, int>> pedidos;
+	pedidos.reserve(nifs.size());
+	for (int j = 0; j < (int)nifs.size(); j++) {
+		if (filtroNIF.podeConter(nifs[j])) {	// NIFs que de certeza nao existem ficam logo vazios
+			pedidos.emplace_back(nifs[j], j);
+		}
+	}
+	std::sort(pedidos.begin(), pedidos.end());
+	pedidos.erase(std::unique(pedidos.begin(), pedidos.end(),
+		[](const std::pair<int, int>& a, const std::pair<int, int>& b) { return a.first == b.first; }), pedidos.end());
+
+	// Posicao em 'pedidos' do NIF (-1 se nao foi pedido)
+	auto pedido = [&pedidos](int nif) {
+		auto p = std::lower_bound(pedidos.begin(), pedidos.end(), nif,
+			[](const std::pair<int, int>& a, int n) { return a.first < n; });
+		return p != pedidos.end() && p->first == nif ? (int)(p - pedidos.begin()) : -1;
+	};
+
+	int numClientes = clientes.getNumRegistos();
+	int encontrados = 0;
+	for (int i = 0; i < numClientes && encontrados < (int)pedidos.size(); i++) {
+		if (i + DISTANCIA < numClientes) {
+			PREFETCH(clientes[i + DISTANCIA]);
+		}
+
+		int p = pedido(clientes[i]->obtemNIF());
+		if (p >= 0) {
+			resultados[pedidos[p].second] = VistaCliente(cacheListagem.nome(i), clientes[i]->obtemNumConsultas());
+			encontrados++;
+		}
+	}
+
+	// Os que nao estavam em 'clientes' podem estar no armazem frio
+	if (encontrados < (int)pedidos.size() && frios.getNumRegistos() > 0) {
+		for (const auto& [nif, j] : pedidos) {
+			if (!resultados[j]) {
+				std::optional<ArmazemFrio::Vista> frio = frios.procurar(nif);
+				if (frio) {
+					resultados[j] = VistaCliente(frio->nome, frio->numConsultas);
+				}
+			}
+		}
+	}
+
+	// NIFs repetidos no lote ficam com o resultado do primeiro pedido
+	for (int j = 0; j < (int)nifs.size(); j++) {
+		int p = pedido(nifs[j]);
+		if (p >= 0 && pedidos[p].second != j) {
+			resultados[j] = resultados[pedidos[p].second];
+		}
+	}
+
+	return resultados;
+#endif
+}
+
+// ============================================================================
+// MAIS CONSULTAS / CONSULTAS ENTRE
+// ============================================================================
+// Respondem a "clientes mais frequentes" e "clientes com entre X e Y
+// consultas" sem percorrer os clientes: usam o indice por numero de consultas,
+// que e atualizado em cada acrescentarClientes, apagarCliente e
+// registarConsulta (ver IndiceConsultas).
+//
+// Exemplo de uso:
+//   armario.acrescentarClientes("Joao", 111);   // 0 consultas
+//   armario.acrescentarClientes("Maria", 222);
+//   armario.registarConsulta(222);              // Maria: 1 consulta
+//
+//   armario.maisConsultas(1);     // [222]
+//   armario.consultasEntre(0, 0); // [111]
+// ============================================================================
+std::vector<int> ArmarioFichas::maisConsultas(int k) const {
+	return indiceConsultas.maisConsultas(k);
+}
+
+std::vector<int> ArmarioFichas::consultasEntre(int minimo, int maximo) const {
+	return indiceConsultas.entre(minimo, maximo);
+}
+
+// ============================================================================
+// PROCURAR POR NOME
+// ============================================================================
+// Devolve os NIFs de todos os clientes cujo nome comeca por 'prefixo', por
+// ordem alfabetica do nome, sem percorrer os clientes: usa o indice por nome
+// (array ordenado + pesquisa binaria, ver IndiceNomes), O(log n + k).
+//
+// Exemplo de uso:
+//   armario.acrescentarClientes("Joao", 111);
+//   armario.acrescentarClientes("Maria", 222);
+//   armario.acrescentarClientes("Joaquim", 333);
+//
+//   armario.procurarPorNome("Jo");  // [111, 333]
+//   armario.procurarPorNome("");    // todos, por ordem alfabetica
+// ============================================================================
+std::vector<int> ArmarioFichas::procurarPorNome(const std::string& prefixo) const {
+	return indiceNomes.procurar(prefixo);
+}
+
+// ============================================================================
+// FILTRO DE BLOOM DE NIFS
+// ============================================================================
+// Muitos pedidos usam NIFs que nao estao no armario (clientes novos, enganos).
+// Sem filtro, cada um percorre o array 'clientes' inteiro ate concluir que
+// nao existe. Com o filtro ativo, a maior parte e rejeitada logo a entrada de
+// apagarCliente, registarConsulta, obterDados e da verificacao de duplicados
+// de acrescentarClientes (ver FiltroBloom).
+//
+// O filtro e dimensionado para o dobro dos clientes atuais. Quando fica cheio
+// (ou no esvaziar e na copia), e reconstruido a partir dos NIFs que existem,
+// o que tambem esquece os NIFs entretanto apagados.
+//
+// Exemplo de uso:
+//   armario.ativarFiltroNIF(true);
+//   armario.registarConsulta(999);  // NIF inexistente: rejeitado pelo filtro
+// ============================================================================
+void ArmarioFichas::ativarFiltroNIF(bool ativo) {
+	if (ativo) {
+		reconstruirFiltroNIF();
+	}
+	else {
+		filtroNIF.dimensionar(0);
+	}
+}
+
+void ArmarioFichas::reconstruirFiltroNIF() {
+	const int CAPACIDADE_MINIMA = 1024;
+
+	// Os NIFs frios tambem entram: e o filtro que evita procurar no armazem frio
+	int numClientes = getNumClientes();
+	filtroNIF.dimensionar(2 * numClientes > CAPACIDADE_MINIMA ? 2 * numClientes : CAPACIDADE_MINIMA);
+	for (int i = 0; i < clientes.getNumRegistos(); i++) {
+		filtroNIF.acrescentar(clientes[i]->obtemNIF());
+	}
+	frios.paraCada([&](const ArmazemFrio::Vista& v) { filtroNIF.acrescentar(v.nif); });
+}
+
+// ============================================================================
+// ORDEM POR NIF (listagemPorNIF / nifsEntre)
+// ============================================================================
+// O array 'clientes' esta pela ordem de chegada, baralhada pelos
+// swap-and-pop de apagarCliente. Para listar por NIF ou responder a "todos os
+// NIFs entre a e b" (auditorias), o modo ordenado mantem uma copia dos NIFs
+// ordenada e preparada para procuras rapidas (ver OrdemNIF):
+//   - Com o modo ativo: procura O(log n) + percorrer so o intervalo pedido.
+//     Os clientes novos/apagados sao aplicados em lote na consulta seguinte.
+//   - Sem o modo ativo: nifsEntre percorre todos os clientes, O(n), e a
+//     listagemPorNIF constroi a ordem na hora, O(n log n).
+//
+// Exemplo de uso:
+//   armario.ativarOrdemNIF(true);
+//   armario.acrescentarClientes("Maria", 222);
+//   armario.acrescentarClientes("Joao", 111);
+//   armario.acrescentarClientes("Ana", 333);
+//
+//   armario.nifsEntre(100, 250);   // [111, 222]
+//   cout << armario.listagemPorNIF();
+//   // Joao / 111 / 0
+//   // Maria / 222 / 0
+//   // Ana / 333 / 0
+// ============================================================================
+void ArmarioFichas::ativarOrdemNIF(bool ativo) {
+	if (ativo) {
+		preencherOrdemNIF(ordemNIF);
+	}
+	else {
+		ordemNIF.ativar(false);
+	}
+}
+
+void ArmarioFichas::preencherOrdemNIF(OrdemNIF& ordem) const {
+	std::vector<Cliente*> todos;
+	todos.reserve(clientes.getNumRegistos());
+	for (int i = 0; i < clientes.getNumRegistos(); i++) {
+		todos.push_back(clientes[i]);
+	}
+	ordem.ativar(true);
+	ordem.acrescentarVarios(todos);
+}
+
+std::string ArmarioFichas::listagemPorNIF() const {
+	OrdemNIF temporaria;
+	const OrdemNIF* ordem = &ordemNIF;
+	if (!ordemNIF.estaAtiva()) {
+		preencherOrdemNIF(temporaria);
+		ordem = &temporaria;
+	}
+	if (frios.getNumRegistos() == 0) {
+		return ordem->listagem();
+	}
+
+	// Os frios ja estao por ordem de NIF: merge com os quentes
+	std::span<const Cliente* const> quentes = ordem->porOrdem();
+	std::string texto;
+	size_t q = 0;
+	auto acrescentarQuentesAte = [&](long long limite) {
+		for (; q < quentes.size() && quentes[q]->obtemNIF() < limite; q++) {
+			texto += quentes[q]->obtemDesc();
+			texto += '\n';
+		}
+	};
+	frios.paraCada([&](const ArmazemFrio::Vista& v) {
+		acrescentarQuentesAte(v.nif);
+		acrescentarLinhaFria(texto, v);
+	});
+	acrescentarQuentesAte(LLONG_MAX);
+	return texto;
+}
+
+std::vector<int> ArmarioFichas::nifsEntre(int minimo, int maximo) const {
+	std::vector<int> resultado;
+	if (ordemNIF.estaAtiva()) {
+		resultado = ordemNIF.entre(minimo, maximo);
+	}
+	else {
+		// Sem a ordem: uma passagem por todos e ordenar so os que estao no intervalo
+		for (int i = 0; i < clientes.getNumRegistos(); i++) {
+			int nif = clientes[i]->obtemNIF();
+			if (nif >= minimo && nif <= maximo) {
+				resultado.push_back(nif);
+			}
+		}
+		std::sort(resultado.begin(), resultado.end());
+	}
+	if (frios.getNumRegistos() == 0) {
+		return resultado;
+	}
+
+	// Os frios no intervalo (ja ordenados) juntam-se aos quentes
+	std::vector<int> nifsFrios = frios.nifsEntre(minimo, maximo);
+	std::vector<int> todos(resultado.size() + nifsFrios.size());
+	std::merge(resultado.begin(), resultado.end(), nifsFrios.begin(), nifsFrios.end(), todos.begin());
+	return todos;
+}
+
+// ============================================================================
+// ARREFECER / PROMOVER (clientes quentes e frios)
+// ============================================================================
+// A maior parte dos clientes nao tem consultas ha anos, mas cada um ocupa um
+// Cliente no heap, a sua linha na 'cacheListagem' e o seu lugar no array que
+// as procuras percorrem. arrefecer() passa os inativos para o armazem frio
+// (comprimidos e ordenados por NIF, ver ArmazemFrio):
+//
+//   relogio = 1000, arrefecer(500)
+//   clientes         -> [111 (900)][222 (120)][333 (990)][444 (300)]
+//                                      frio                  frio
+//   clientes         -> [111][333]               (mesma ordem)
+//   frios            -> [222][444]
+//
+// A "idade" de um cliente conta-se em operacoes do armario ('relogio':
+// acrescentar e registar consultas), nao em tempo, para o resultado nao
+// depender da maquina.
+//
+// Os clientes frios continuam a ser clientes do armario para tudo o resto:
+//   - registarConsulta, obterDados e verDados promovem o cliente (volta ao fim
+//     de 'clientes'); num armario const, obterDados/verDados leem-no do
+//     armazem frio sem o promover
+//   - apagarCliente, listagens, nifsEntre, publicar e copias incluem-nos
+//   - indiceNomes, indiceConsultas e o filtro de Bloom tem-nos sempre
+//     (nao mudam ao arrefecer nem ao promover)
+//
+// A listagem() tambem nao muda: cada cliente tem o seu lugar na listagem
+// ('ordemListagem', dado ao acrescenta-lo), que vai com ele para o armazem
+// frio e volta com ele ao ser promovido. A listagem junta quentes e frios por
+// esse lugar (ver juntarListagem), por isso arrefecer/promover nunca trocam
+// a ordem das linhas:
+//
+//   ordemListagem -> [111 (0)][333 (2)]         frios -> [222 (1)][444 (3)]
+//   listagem      -> 111, 222, 333, 444
+//   obterDados(222): clientes -> [111 (0)][333 (2)][222 (1)]   listagem igual
+//
+// Exemplo de uso:
+//   armario.arrefecer(1000000);       // inativos ha mais de 10^6 operacoes
+//   armario.getNumClientesFrios();    // quantos estao no armazem frio
+//   armario.registarConsulta(222);    // 222 volta a ser quente
+//   armario.obterDados(444);          // 444 tambem
+// ============================================================================
+int ArmarioFichas::arrefecer(unsigned long long operacoes) {
+	MEDIR("ArmarioFichas::arrefecer");
+
+	int n = clientes.getNumRegistos();
+	std::vector<char> marcados(n, 0);
+	std::vector<ArmazemFrio::Registo> novosFrios;
+	for (int i = 0; i < n; i++) {
+		if (relogio - ultimaAtividade[i] >= operacoes) {
+			marcados[i] = 1;
+			novosFrios.push_back(ArmazemFrio::Registo{ std::string(cacheListagem.nome(i)), clientes[i]->obtemNIF(), clientes[i]->obtemNumConsultas(), ordemListagem[i] });
+		}
+	}
+	int numArrefecidos = (int)novosFrios.size();
+	if (numArrefecidos == 0) {
+		return 0;
+	}
+
+	// A ordem por NIF so tem os quentes (e aponta para os Clientes que vao ser destruidos)
+	if (ordemNIF.estaAtiva()) {
+		for (const ArmazemFrio::Registo& r : novosFrios) {
+			ordemNIF.remover(r.nif);
+		}
+	}
+	frios.acrescentarVarios(std::move(novosFrios));
+
+	// Os que ficam juntam-se pela mesma ordem em 'clientes', na cache da listagem, em 'ultimaAtividade' e em 'ordemListagem'
+	clientes.removerMarcados(marcados);
+	cacheListagem.removerMarcadas(marcados);
+	int j = 0;
+	for (int i = 0; i < n; i++) {
+		if (marcados[i] == 0) {
+			ultimaAtividade[j] = ultimaAtividade[i];
+			ordemListagem[j] = ordemListagem[i];
+			j++;
+		}
+	}
+	ultimaAtividade.resize(j);
+	ultimaAtividade.shrink_to_fit();
+	ordemListagem.resize(j);
+	ordemListagem.shrink_to_fit();
+
+	textoFriosValido = false;
+	textoCompletoValido = false;
+	return numArrefecidos;
+}
+
+int ArmarioFichas::promover(int nif) {
+	ArmazemFrio::Registo frio;
+	if (frios.getNumRegistos() == 0 || !filtroNIF.podeConter(nif) || !frios.retirar(nif, frio)) {
+		return -1;
+	}
+	tornarQuentes(std::span<const ArmazemFrio::Registo>(&frio, 1));
+	return clientes.getNumRegistos() - 1;
+}
+
+// Um NIF esta quente ou frio, nunca nos dois: os que 'frios' ainda tiver sao frios
+// (NIFs repetidos no lote so sao encontrados da primeira vez)
+int ArmarioFichas::promoverVarios(std::span<const int> nifs) {
+	if (frios.getNumRegistos() == 0) {
+		return 0;
+	}
+	std::vector<ArmazemFrio::Registo> promovidos;
+	for (int nif : nifs) {
+		ArmazemFrio::Registo frio;
+		if (filtroNIF.podeConter(nif) && frios.retirar(nif, frio)) {
+			promovidos.push_back(std::move(frio));
+		}
+	}
+	if (!promovidos.empty()) {
+		tornarQuentes(promovidos);
+	}
+	return (int)promovidos.size();
+}
+
+void ArmarioFichas::tornarQuentes(std::span<const ArmazemFrio::Registo> promovidos) {
+	std::vector<Cliente*> novos;
+	novos.reserve(promovidos.size());
+	for (const ArmazemFrio::Registo& frio : promovidos) {
+		// Cliente nao tem setter para numConsultas: novaConsulta() repetido ate igualar
+		Cliente* novo = new Cliente(frio.nome, frio.nif);
+		for (int c = 0; c < frio.numConsultas; c++) {
+			novo->novaConsulta();
+		}
+		novos.push_back(novo);
+		cacheListagem.acrescentar(novo->obtemDesc() + '\n', (int)frio.nome.size());
+		ultimaAtividade.push_back(++relogio);
+
+		// Volta com o seu lugar na listagem, normalmente antes do ultimo quente
+		if (!ordemListagem.empty() && frio.ordem < ordemListagem.back()) {
+			quentesForaDeOrdem = true;
+		}
+		ordemListagem.push_back(frio.ordem);
+		if (ordemNIF.estaAtiva()) {
+			ordemNIF.acrescentar(novo);	// fica pendente (acrescentarVarios consolidaria ja)
+		}
+	}
+	clientes.acrescentarVarios(novos);
+
+	textoFriosValido = false;
+	textoCompletoValido = false;
+}
+
+// ============================================================================
+// PUBLICAR / LER (versoes para leitores concorrentes)
+// ============================================================================
+// Um relatorio demorado (listagem, comparar armarios, copiar) numa thread nao
+// pode ler 'clientes' enquanto outra thread escreve: apagarCliente faz
+// swap-and-pop e realoca o array "debaixo" do leitor.
+//
+// Em vez disso, o escritor publica versoes IMUTAVEIS (VersaoArmario):
+//
+//   escritor:  alterar ... publicar() ... alterar ... publicar()
+//                              |                         |
+//   versaoPublicada ------> [V1] -----------------------> [V2]
+//                              ^                          (V1 retirada)
+//   leitor:      Leitura l(armario) -- le V1 -- fim --> V1 apagada
+//
+//   - Os leitores nunca bloqueiam o escritor, nem o escritor os leitores
+//   - Uma Leitura ve sempre a mesma versao, do principio ao fim
+//   - A versao antiga so e apagada quando nenhuma Leitura a pode estar a usar
+//     (reclamacao por epocas, ver GestorEpocas)
+//
+// publicar() e chamado pelo escritor (so uma thread escreve no armario) quando
+// quer que as alteracoes fiquem visiveis, ex: no fim de cada lote.
+// Custa O(n) (copia as fichas e a listagem ja em cache).
+//
+// Exemplo de uso:
+//   // Thread escritora                 // Thread leitora
+//   armario.registarConsulta(111);      ArmarioFichas::Leitura l(armario);
+//   armario.publicar();                 cout << l->listagem();
+//                                       bool iguais = (*l == *outra.ler());
+// ============================================================================
+void ArmarioFichas::publicar() {
+	std::vector<VersaoArmario::Ficha> fichas;
+	fichas.reserve(getNumClientes());
+	for (int i = 0; i < clientes.getNumRegistos(); i++) {
+		fichas.emplace_back(cacheListagem.nome(i), clientes[i]->obtemNIF(), clientes[i]->obtemNumConsultas());
+	}
+	frios.paraCada([&](const ArmazemFrio::Vista& v) { fichas.emplace_back(v.nome, v.nif, v.numConsultas); });
+
+	std::string texto;
+	acrescentarListagem(texto);
+	const VersaoArmario* nova = new VersaoArmario(std::move(fichas), std::move(texto), ++numVersoes);
+
+	// A partir daqui novos leitores ja veem a versao nova
+	const VersaoArmario* antiga = versaoPublicada.exchange(nova);
+	if (antiga != nullptr) {
+		GestorEpocas::global().retirar(antiga);
+	}
+}
+
+ArmarioFichas::Leitura::Leitura(const ArmarioFichas& armario) {
+	GestorEpocas::global().entrar();
+	const VersaoArmario* publicada = armario.versaoPublicada.load();
+	versao = publicada != nullptr ? publicada : &VersaoArmario::vazia();
+}
+
+ArmarioFichas::Leitura::~Leitura() {
+	GestorEpocas::global().sair();
+}
+
+// ============================================================================
+// ALTERACOES DESDE / APLICAR ALTERACOES (replicas)
+// ============================================================================
+// Para manter uma replica de um armario noutra thread ou processo, copiar
+// tudo com operator= sempre que algo muda e caro. Em vez disso:
+//
+//   principal: ... acrescentarClientes, registarConsulta, apagarCliente ...
+//              auto dados = principal.alteracoesDesde(replica.getSequencia());
+//                               |  (string binaria: pode ir por um pipe ou ficheiro)
+//                               v
+//   replica:   replica.aplicarAlteracoes(*dados);
+//
+// O principal tem de ter o registo ativo (ativarRegistoAlteracoes(true)):
+// por omissao so se conta a sequencia, e alteracoesDesde so responde a uma
+// replica que ja esta em dia. A replica nao precisa de o ativar.
+//
+// A replica aplica as mesmas operacoes pela mesma ordem, por isso fica com a
+// mesma sequencia que o principal. Entradas que ja tinha aplicado sao
+// ignoradas (pode receber o mesmo lote duas vezes).
+//
+// Se alteracoesDesde devolver vazio (replica atrasada demais), ou se
+// aplicarAlteracoes devolver false (buraco nas sequencias, ou a replica ja nao
+// tem os mesmos clientes), a replica tem de voltar a ser copiada por inteiro.
+// ============================================================================
+std::optional<std::string> ArmarioFichas::alteracoesDesde(unsigned long long desde) const {
+	return alteracoes.codificarDesde(desde);
+}
+
+bool ArmarioFichas::aplicarAlteracoes(std::string_view dados) {
+	std::vector<RegistoAlteracoes::Alteracao> lista;
+	if (!RegistoAlteracoes::descodificar(dados, lista)) {
+		return false;
+	}
+
+	// Clientes novos seguidos sao acrescentados num so lote
+	std::vector<RegistoCliente> novos;
+	auto acrescentarNovos = [&]() {
+		bool ok = novos.empty() || acrescentarLote(novos) == 0;
+		novos.clear();
+		return ok;
+	};
+
+	for (const RegistoAlteracoes::Alteracao& a : lista) {
+		unsigned long long sequencias = a.tipo == RegistoAlteracoes::Tipo::CONSULTAS ? a.valor : 1;
+		unsigned long long atual = getSequencia() + novos.size();
+
+		if (a.sequencia + sequencias - 1 <= atual) {
+			continue;	// ja aplicada
+		}
+		if (a.sequencia > atual + 1) {
+			return false;	// buraco: faltam alteracoes
+		}
+
+		if (a.tipo == RegistoAlteracoes::Tipo::ACRESCENTAR) {
+			novos.push_back(RegistoCliente{ a.nome, a.nif, a.valor });
+			continue;
+		}
+		if (!acrescentarNovos()) {
+			return false;
+		}
+
+		switch (a.tipo) {
+		case RegistoAlteracoes::Tipo::APAGAR:
+			if (!apagarCliente(a.nif)) {
+				return false;
+			}
+			break;
+		case RegistoAlteracoes::Tipo::CONSULTAS:
+			// Parte do grupo de consultas pode ja ter sido aplicada
+			for (unsigned long long c = atual + 1; c < a.sequencia + sequencias; c++) {
+				if (!registarConsulta(a.nif)) {
+					return false;
+				}
+			}
+			break;
+		case RegistoAlteracoes::Tipo::ESVAZIAR:
+			esvaziar();
+			break;
+		default:
+			break;
+		}
+	}
+
+	return acrescentarNovos();
+}
+
 // ============================================================================
 // ESVAZIAR
 // ============================================================================
@@ -561,36 +1191,36 @@ ArmarioFichas::InfoCliente ArmarioFichas::obterDados(int nif) const {
 //   // armario agora esta VAZIO (0 clientes)
 // ============================================================================
 void ArmarioFichas::esvaziar() {
-	// Libertar cada OBJETO Cliente individualmente
-	for (int i = 0; i < numClientes; i++) {
-		delete clientes[i];
-		// Liberta a memoria alocada para o objeto Cliente apontado por clientes[i]
-		// Exemplo: Se clientes[0] aponta para 0x1000, liberta o objeto em 0x1000
-	}
+	// Libertar cada OBJETO Cliente individualmente e depois o ARRAY de
+	// ponteiros (ver Armario::esvaziar)
+	clientes.esvaziar();
 	// Visualizacao:
 	//   clientes -> [ptr0][ptr1][ptr2]
 	//                 X     X     X
 	//                 ✗     ✗     ✗  (objetos destruidos)
+	//   clientes -> [LIBERTADO]  (array destruido, ponteiro a nullptr)
 
-	// Libertar o ARRAY de ponteiros
-	delete[] clientes;
-	// Liberta o array em si (os ponteiros do tipo Cliente*) 
-	// Os objetos ja foram libertados em cima
-	//
-	// Visualizacao:
-	//   clientes -> [LIBERTADO]  (array destruido)
-
-	// Reinicializar para o estado INICIAL (vazio)
-	numClientes = 0;
-	// Contador volta a zero
-
-	clientes = nullptr;
-	// IMPORTANTE! Define o ponteiro como nullptr para evitar dangling pointer
-	// Sem isto, 'clientes' apontaria para memoria ja libertada (perigoso!)
-	//
+	cacheListagem.limpar();
+	indiceConsultas.limpar();
+	indiceNomes.limpar();
+	alteracoes.esvaziado();
+	if (filtroNIF.ativo()) {
+		reconstruirFiltroNIF();	// fica vazio, mas continua ativo
+	}
+	ordemNIF.limpar();			// idem
+	frios.limpar();
+	ultimaAtividade.clear();
+	ordemListagem.clear();
+	proximaOrdem = 0;
+	quentesForaDeOrdem = false;
+	textoFrios = std::string();
+	ordemFrios = std::vector<unsigned long long>();
+	inicioFrios = std::vector<size_t>();
+	textoFriosValido = false;
+	textoCompleto = std::string();
+	textoCompletoValido = false;
 	// Estado FINAL:
-	//   numClientes = 0
-	//   clientes = nullptr
+	//   0 clientes, array a nullptr
 	//   (equivalente ao estado apos construtor default)
 }
 
@@ -601,8 +1231,34 @@ void ArmarioFichas::esvaziar() {
 // Cada cliente aparece numa linha separada.
 // Usa o metodo obtemDesc() da classe Cliente para obter a descricao.
 //
+// A listagem NAO e construida aqui: cada operacao que altera um cliente
+// (acrescentarClientes, apagarCliente, registarConsulta) ja atualizou a linha
+// desse cliente no texto da 'cacheListagem' (cada linha so existe la):
+//   - Nenhuma linha mudou de sitio desde a ultima listagem (alteracoes que
+//     mantem o comprimento da linha sao escritas no lugar): O(1)
+//   - Senao (ex: apagarCliente, ou 9 -> 10 consultas) as linhas voltam a ser
+//     juntas pela ordem dos clientes, O(n) bytes copiados em blocos (ver
+//     CacheListagem)
+//
+// Nao e seguro chamar verListagem() (nem listagem(), que a copia) em varias
+// threads ao mesmo tempo, mesmo sendo const: o texto guardado e posto em dia
+// aqui. Leitores concorrentes usam publicar()/ler().
+//
+// Com clientes frios, cada linha fica no seu lugar na listagem (o mesmo que
+// tinha antes de arrefecer, ver arrefecer). As linhas dos frios ficam num
+// texto a parte, 'textoFrios', pela ordem da listagem, que so e refeito
+// (descodificando o armazem frio) quando 'frios' muda. Uma alteracao a um
+// cliente quente nao toca nesse texto, mas a referencia devolvida tem de ser
+// uma so string, por isso verListagem() volta a juntar quentes e frios numa
+// copia (merge pelo lugar na listagem, ver juntarListagem): O(n) bytes
+// copiados, sem descodificar nada. acrescentarListagem() escreve o merge
+// diretamente no destino e evita essa copia. O mesmo acontece sem frios
+// quando um cliente promovido ainda esta fora do seu lugar em 'clientes'.
+//
 // Retorno:
-//   - String com a listagem completa (uma linha por cliente)
+//   - verListagem(): referencia para a listagem completa (uma linha por
+//     cliente), valida ate a proxima alteracao do armario (sem copias)
+//   - listagem(): uma copia dessa listagem, que e do chamador
 //   - String VAZIA se o armario nao tiver clientes
 //
 // Exemplo de uso:
@@ -617,38 +1273,172 @@ void ArmarioFichas::esvaziar() {
 //   // Maria / 222 / 0
 // ============================================================================
 std::string ArmarioFichas::listagem() const {
-	// Criar um ostringstream para construir a string de forma eficiente
-	std::ostringstream oss;
-	// ostringstream permite "acumular" texto como se fosse um cout,
-	// mas em vez de imprimir no ecra, guarda numa string
-
-	// Percorrer todos os clientes do armario
-	for (int i = 0; i < numClientes; i++) {
-		// Adicionar a descricao do cliente 'i' ao stream
-		oss << clientes[i]->obtemDesc() << std::endl;
-		// obtemDesc() retorna: "nome / nif / numConsultas"
-		// std::endl adiciona uma quebra de linha
-		//
-		// Exemplo: Se cliente[0] e "Joao / 111 / 1",
-		//          oss contem: "Joao / 111 / 1\n"
+	return verListagem();
+}
+
+const std::string& ArmarioFichas::verListagem() const {
+	MEDIR("ArmarioFichas::verListagem");
+	// 'cacheListagem' e 'mutable': o armario (logicamente) nao muda,
+	// so o texto guardado e posto em dia
+	if (frios.getNumRegistos() == 0 && !quentesForaDeOrdem) {
+		return cacheListagem.obter();
 	}
 
-	// Converter o ostringstream para string e retornar
-	return oss.str();
-	// str() extrai a string completa do ostringstream
-	//
-	// Visualizacao do processo:
-	//   clientes -> [Cliente0][Cliente1][Cliente2]
-	//                "Joao/111" "Maria/222" "Pedro/333"
-	//
-	//   Loop:
-	//     i=0: oss += "Joao / 111 / 1\n"
-	//     i=1: oss += "Maria / 222 / 0\n"
-	//     i=2: oss += "Pedro / 333 / 2\n"
-	//
-	//   Retorno: "Joao / 111 / 1\nMaria / 222 / 0\nPedro / 333 / 2\n"
-	//
-	// Se armario vazio (numClientes=0):
-	//   Loop nao executa, oss fica vazio
-	//   Retorna: "" (string vazia)
-}
\ No newline at end of file
+	// Com clientes frios: quentes e frios juntos pelo lugar na listagem,
+	// de novo so depois de alguma alteracao
+	if (!textoCompletoValido) {
+		textoCompleto.clear();
+		juntarListagem(textoCompleto);
+		textoCompletoValido = true;
+	}
+	return textoCompleto;
+}
+
+void ArmarioFichas::acrescentarListagem(std::string& saida) const {
+	MEDIR("ArmarioFichas::acrescentarListagem");
+	if (frios.getNumRegistos() == 0 && !quentesForaDeOrdem) {
+		saida += cacheListagem.obter();
+		return;
+	}
+	juntarListagem(saida);
+}
+
+const std::string& ArmarioFichas::listagemFrios() const {
+	if (!textoFriosValido) {
+		// O armazem esta por ordem de NIF: as vistas sao ordenadas pelo lugar na listagem
+		std::vector<ArmazemFrio::Vista> vistas;
+		vistas.reserve(frios.getNumRegistos());
+		frios.paraCada([&](const ArmazemFrio::Vista& v) { vistas.push_back(v); });
+		std::sort(vistas.begin(), vistas.end(),
+			[](const ArmazemFrio::Vista& a, const ArmazemFrio::Vista& b) { return a.ordem < b.ordem; });
+
+		// Cada linha fria tem no maximo o registo comprimido + " / " x2 + NIF + '\n' + digitos das consultas
+		textoFrios.clear();
+		textoFrios.reserve(frios.getBytes() + 24 * vistas.size());
+		ordemFrios.assign(vistas.size(), 0);
+		inicioFrios.assign(vistas.size() + 1, 0);
+		for (size_t k = 0; k < vistas.size(); k++) {
+			ordemFrios[k] = vistas[k].ordem;
+			inicioFrios[k] = textoFrios.size();
+			acrescentarLinhaFria(textoFrios, vistas[k]);
+		}
+		inicioFrios[vistas.size()] = textoFrios.size();
+		textoFrios.shrink_to_fit();
+		textoFriosValido = true;
+	}
+	return textoFrios;
+}
+
+// Merge dos quentes (pelo seu lugar na listagem) com as linhas de 'textoFrios'
+// (ja por essa ordem); os frios seguidos sao copiados de uma so vez:
+//
+//   quentes -> [111 (0)][333 (2)]       frios -> [222 (1)][444 (3)][555 (4)]
+//   saida   -> 111 | 222 | 333 | 444 555
+void ArmarioFichas::juntarListagem(std::string& saida) const {
+	const std::string& linhasFrias = listagemFrios();
+	int numQuentes = clientes.getNumRegistos();
+
+	// Os quentes so estao fora de ordem depois de promover (voltam para o fim de 'clientes')
+	if (quentesForaDeOrdem && std::is_sorted(ordemListagem.begin(), ordemListagem.end())) {
+		quentesForaDeOrdem = false;
+	}
+	std::vector<int> posicoes;
+	if (quentesForaDeOrdem) {
+		posicoes.resize(numQuentes);
+		std::iota(posicoes.begin(), posicoes.end(), 0);
+		std::sort(posicoes.begin(), posicoes.end(), [this](int a, int b) { return ordemListagem[a] < ordemListagem[b]; });
+	}
+
+	size_t tamanho = saida.size() + linhasFrias.size();
+	for (int i = 0; i < numQuentes; i++) {
+		tamanho += cacheListagem.linha(i).size();
+	}
+	saida.reserve(tamanho);
+
+	size_t k = 0;
+	for (int j = 0; j < numQuentes; j++) {
+		int i = posicoes.empty() ? j : posicoes[j];
+		size_t fim = k;
+		while (fim < ordemFrios.size() && ordemFrios[fim] < ordemListagem[i]) {
+			fim++;
+		}
+		saida.append(linhasFrias, inicioFrios[k], inicioFrios[fim] - inicioFrios[k]);
+		k = fim;
+		saida += cacheListagem.linha(i);
+	}
+	saida.append(linhasFrias, inicioFrios[k], std::string::npos);
+}
+
+// ============================================================================
+// LISTAGEM POR NOME
+// ============================================================================
+// As mesmas linhas da listagem(), mas por ordem alfabetica do nome (as listas
+// impressas de pacientes). Nomes iguais ficam por ordem de NIF.
+//
+// Nenhum Cliente e movido nem nenhum nome copiado:
+//   1) Os nomes sao vistos diretamente nas linhas da 'cacheListagem' (os dos
+//      clientes frios, dentro dos blocos do armazem frio)
+//   2) Ordena-se uma permutacao de posicoes com radix sort (ver OrdenacaoNomes)
+//   3) O texto e montado copiando as linhas ja formatadas por essa ordem (so
+//      as dos frios sao formatadas aqui)
+//
+//   clientes -> [0 Rui][1 Ana][2 Rita]
+//   ordem    -> [1][2][0]
+//   texto    -> "Ana / ...\nRita / ...\nRui / ...\n"
+//
+// Custo O(n * comprimento do prefixo que distingue os nomes), sem comparacoes
+// de strings inteiras.
+//
+// Exemplo de uso:
+//   armario.acrescentarClientes("Maria", 222);
+//   armario.acrescentarClientes("Joao", 111);
+//   armario.acrescentarClientes("Ana", 333);
+//
+//   cout << armario.listagemPorNome();
+//   // Ana / 333 / 0
+//   // Joao / 111 / 0
+//   // Maria / 222 / 0
+// ============================================================================
+std::string ArmarioFichas::listagemPorNome() const {
+	MEDIR("ArmarioFichas::listagemPorNome");
+	// Posicoes [0, numQuentes) sao de 'clientes', as seguintes do armazem frio
+	int numQuentes = clientes.getNumRegistos();
+	int n = getNumClientes();
+	std::vector<std::string_view> nomes(n);
+	std::vector<int> nifs(n);
+	std::vector<int> consultasFrios;
+	consultasFrios.reserve(n - numQuentes);
+	size_t tamanho = 0;
+	for (int i = 0; i < numQuentes; i++) {
+		nomes[i] = cacheListagem.nome(i);
+		nifs[i] = clientes[i]->obtemNIF();
+		tamanho += cacheListagem.linha(i).size();
+	}
+	int k = numQuentes;
+	frios.paraCada([&](const ArmazemFrio::Vista& v) {
+		nomes[k] = v.nome;
+		nifs[k] = v.nif;
+		consultasFrios.push_back(v.numConsultas);
+		tamanho += v.nome.size() + 16;
+		k++;
+	});
+
+	std::vector<int> ordem = OrdenacaoNomes(nomes, nifs).ordenar();
+
+	std::string texto;
+	texto.reserve(tamanho);
+	for (int i = 0; i < n; i++) {
+		// O nome e o inicio da linha: pedir a linha de ordem[i + 16] a cache ja
+		if (i + 16 < n) {
+			PREFETCH(nomes[ordem[i + 16]].data());
+		}
+		int p = ordem[i];
+		if (p < numQuentes) {
+			texto += cacheListagem.linha(p);
+		}
+		else {
+			acrescentarLinhaFria(texto, ArmazemFrio::Vista{ nomes[p], nifs[p], consultasFrios[p - numQuentes], 0 });
+		}
+	}
+	return texto;
+}
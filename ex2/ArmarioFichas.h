@@ -1,9 +1,38 @@
 ﻿#pragma once
 #include "Cliente.h"
+#include "Armario.h"
+#include "ArmazemFrio.h"
+#include "IndiceDiretoNIF.h"
+#include "CacheListagem.h"
+#include "IndiceConsultas.h"
+#include "IndiceNomes.h"
+#include "FiltroBloom.h"
+#include "OrdemNIF.h"
+#include "VersaoArmario.h"
+#include "RegistoAlteracoes.h"
+#include <atomic>
+#include <optional>
+#include <span>
+#include <string_view>
 
 class ArmarioFichas
 {
-	Cliente** clientes;		// clientes um Array dinâmicos de ponteiros do tipo Cliente
+	// Extrator da chave dos clientes no Armario genérico
+	struct NifDoCliente {
+		int operator()(const Cliente& c) const { return c.obtemNIF(); }
+	};
+
+	// Os clientes, num Armario genérico (ver Armario.h) instanciado para Cliente.
+	// A procura pelo NIF é escolhida em tempo de compilação:
+	//   - por omissão, procura linear (pouca memória, bom para poucos clientes)
+	//   - com INDICE_NIF_DIRETO definido no projeto, tabela de páginas endereçada
+	//     pelo NIF (ver IndiceDiretoNIF.h), para milhões de clientes
+	// Por dentro continua a ser um Cliente** :
+#ifdef INDICE_NIF_DIRETO
+	Armario<Cliente, NifDoCliente, IndiceDiretoNIF> clientes;
+#else
+	Armario<Cliente, NifDoCliente, IndiceLinear> clientes;
+#endif
 	
 	// Cliente* seria um array de OBJETOS Cliente, o que exigiria:
 	//   - new Cliente[n] chamaria o construtor default Cliente() n vezes
@@ -24,8 +53,31 @@ class ArmarioFichas
 	- Tamanho fixo/pequeno → Cliente* (array de objetos)
 	- Tamanho variável/grande → Cliente** (array de ponteiros)
 	*/
-	
-	int numClientes;		// Número atual de clientes 
+
+	mutable CacheListagem cacheListagem;	// Listagem já formatada, uma linha por cliente (mesma posição que em 'clientes')
+	IndiceConsultas indiceConsultas;		// NIFs ordenados por número de consultas
+	IndiceNomes indiceNomes;				// (nome, NIF) ordenados por nome, para procurar por prefixo
+	FiltroBloom filtroNIF;					// Rejeita NIFs inexistentes sem percorrer 'clientes' (opcional, desativado por omissão)
+	OrdemNIF ordemNIF;						// Clientes ordenados por NIF, para listagens e intervalos (opcional, desativado por omissão)
+
+	std::atomic<const VersaoArmario*> versaoPublicada;	// Última versão publicada para os leitores (nullptr = nenhuma)
+	unsigned long long numVersoes;						// Número de versões publicadas até agora
+
+	RegistoAlteracoes alteracoes;			// Alterações recentes, cada uma com o seu número de sequência (para réplicas)
+
+	// Clientes inativos há muito tempo saem de 'clientes' para o armazém frio (ver arrefecer())
+	ArmazemFrio frios;							// Clientes frios, comprimidos e ordenados por NIF
+	std::vector<unsigned long long> ultimaAtividade;	// ultimaAtividade[i] = 'relogio' da última operação do cliente i
+	unsigned long long relogio;					// Conta as operações sobre clientes (acrescentar, consultas)
+	std::vector<unsigned long long> ordemListagem;	// ordemListagem[i] = lugar do cliente i na listagem (o dos frios fica no armazém frio)
+	unsigned long long proximaOrdem;			// Lugar na listagem do próximo cliente acrescentado
+	mutable bool quentesForaDeOrdem;			// 'ordemListagem' pode não estar por ordem crescente (depois de promover)
+	mutable std::string textoFrios;				// Linhas dos frios, pela ordem da listagem (refeitas só quando 'frios' muda)
+	mutable std::vector<unsigned long long> ordemFrios;	// ordemFrios[k] = lugar na listagem da linha k de 'textoFrios'
+	mutable std::vector<size_t> inicioFrios;	// inicioFrios[k] = deslocamento da linha k em 'textoFrios' (+ sentinela no fim)
+	mutable bool textoFriosValido;
+	mutable std::string textoCompleto;			// Quentes e frios juntos pela ordem da listagem (só usada se houver frios ou quentes fora de ordem)
+	mutable bool textoCompletoValido;
 
 	class InfoCliente {
 		std::string nomeCliente;
@@ -40,10 +92,88 @@ class ArmarioFichas
 		int getNumConsultas() const { return numConsultas; }
 	};
 
+	//Posição do cliente com este NIF em 'clientes' (-1 se não existir)
+	int posicaoDe(int nif) const;
+
+	//Voltar a construir o filtro de Bloom a partir dos NIFs atuais
+	void reconstruirFiltroNIF();
+
+	//Pôr em 'ordem' todos os clientes atuais (ativa-a)
+	void preencherOrdemNIF(OrdemNIF& ordem) const;
+
+	//Dados do cliente com este NIF no armazém frio (vazio se não estiver frio)
+	std::optional<ArmazemFrio::Vista> verFrio(int nif) const;
+
+	//Trazer o cliente com este NIF do armazém frio para 'clientes' (devolve a posição, -1 se não estiver frio)
+	int promover(int nif);
+
+	//Trazer de uma vez do armazém frio os clientes destes NIFs que lá estiverem (devolve quantos)
+	int promoverVarios(std::span<const int> nifs);
+
+	//Pôr no fim de 'clientes' registos já tirados do armazém frio
+	void tornarQuentes(std::span<const ArmazemFrio::Registo> promovidos);
+
+	//Linhas dos clientes frios, pela ordem da listagem (refeitas só depois de 'frios' mudar)
+	const std::string& listagemFrios() const;
+
+	//Acrescentar a 'saida' as linhas dos quentes e dos frios, pela ordem da listagem
+	void juntarListagem(std::string& saida) const;
+
 public:
+	// Máximo de consultas de um cliente acrescentado de uma vez (acrescentarLote,
+	// importação, réplicas): Cliente só conta consultas uma a uma (novaConsulta()),
+	// por isso uma contagem absurda prenderia o armário durante minutos
+	static const int MAX_CONSULTAS = RegistoAlteracoes::MAX_CONSULTAS;
+
+	// Vista "leve" dos dados de um cliente: NAO copia o nome.
+	// O nome aponta para a memória do próprio armário, por isso a vista só é
+	// válida até à próxima alteração do armário ou à próxima listagem()/verListagem().
+	class VistaCliente {
+		std::string_view nomeCliente;
+		int numConsultas;
+
+	public:
+		//Construtor
+		VistaCliente(std::string_view nomeClienteP, int numConsultasP) : nomeCliente(nomeClienteP), numConsultas(numConsultasP) {}
+
+		//Getters
+		std::string_view getNomeCliente() const { return nomeCliente; }
+		int getNumConsultas() const { return numConsultas; }
+	};
+
+	// Dados de um cliente a acrescentar em lote (ex: uma linha de um ficheiro importado)
+	struct RegistoCliente {
+		std::string_view nome;
+		int nif;
+		int numConsultas;
+	};
+
+	// Leitura de uma versão publicada (ver publicar()).
+	// Enquanto o objeto Leitura existir, a versão lida não é apagada, mesmo que
+	// o escritor publique versões novas entretanto.
+	class Leitura {
+		const VersaoArmario* versao;
+
+	public:
+		//Construtor (fixa a versão publicada neste momento)
+		explicit Leitura(const ArmarioFichas& armario);
+
+		//Destrutor (liberta a versão para poder vir a ser apagada)
+		~Leitura();
+
+		Leitura(const Leitura&) = delete;
+		Leitura& operator=(const Leitura&) = delete;
+
+		const VersaoArmario& operator*() const { return *versao; }
+		const VersaoArmario* operator->() const { return versao; }
+	};
+
 	//Construtor da Classe
 	ArmarioFichas();
 
+	//Construtor a partir de uma versão publicada (cópia de um instantâneo)
+	explicit ArmarioFichas(const VersaoArmario& versao);
+
 	//Construtor por Cópia
 	ArmarioFichas(const ArmarioFichas& outra);
 
@@ -56,22 +186,98 @@ public:
 	//Acrescentar clientes
 	bool acrescentarClientes(const std::string& nome, int nif); // dadas as informações necessárias a um novo cliente, logo são os parâmetros que são necessários para "construir" um cliente
 
+	//Acrescentar vários clientes de uma só vez (devolve o número de registos rejeitados: NIF duplicado ou consultas fora de 0..MAX_CONSULTAS)
+	int acrescentarLote(std::span<const RegistoCliente> registos);
+
 	//Apagar cliente
 	bool apagarCliente(int nif);
 
 	//Registar uma nova consulta dado NIF
 	bool registarConsulta(int nif);
 
-	//Obter nome e número de consultas de um cliente dado NIF
+	//Obter nome e número de consultas de um cliente dado NIF (um cliente frio volta a ser quente)
+	InfoCliente obterDados(int nif);
+
+	//Igual, num armário const: um cliente frio é lido do armazém frio, sem ser promovido
 	InfoCliente obterDados(int nif) const;
 
+	//Ver nome e número de consultas de um cliente dado NIF, sem copiar o nome (vazio se não existir; um cliente frio volta a ser quente)
+	std::optional<VistaCliente> verDados(int nif);
+
+	//Igual, num armário const (sem promover: o nome de um cliente frio aponta para o armazém frio)
+	std::optional<VistaCliente> verDados(int nif) const;
+
+	//Ver os dados de vários clientes de uma só vez (resultados[i] corresponde a nifs[i]; os frios voltam a ser quentes)
+	std::vector<std::optional<VistaCliente>> obterDados(std::span<const int> nifs);
+
+	//Igual, num armário const (sem promover)
+	std::vector<std::optional<VistaCliente>> obterDados(std::span<const int> nifs) const;
+
+	//Ativar/desativar o filtro de Bloom de NIFs
+	void ativarFiltroNIF(bool ativo);
+
+	//Ativar/desativar a ordem por NIF (listagemPorNIF e nifsEntre ficam mais rápidos)
+	void ativarOrdemNIF(bool ativo);
+
+	//Publicar o estado atual como uma nova versão imutável, para os leitores
+	void publicar();
+
+	//Ler a última versão publicada (pode ser chamado noutras threads)
+	Leitura ler() const { return Leitura(*this); }
+
+	//Ativar/desativar o registo de alterações (sem ele, alteracoesDesde só serve réplicas já em dia)
+	void ativarRegistoAlteracoes(bool ativo) { alteracoes.ativar(ativo); }
+
+	//Número de sequência da última alteração
+	unsigned long long getSequencia() const { return alteracoes.getSequencia(); }
+
+	//Alterações depois da sequência 'desde', codificadas (vazio se a réplica tiver de copiar tudo)
+	std::optional<std::string> alteracoesDesde(unsigned long long desde) const;
+
+	//Aplicar alterações codificadas por alteracoesDesde de outro armário (réplica)
+	bool aplicarAlteracoes(std::string_view dados);
+
 	//Esvaziar o conjunto de clientes
 	void esvaziar();
 
-	//Obter a listagem de clientes
+	//Obter os NIFs dos k clientes com mais consultas (por ordem decrescente de consultas)
+	std::vector<int> maisConsultas(int k) const;
+
+	//Obter os NIFs dos clientes com número de consultas entre minimo e maximo (inclusive)
+	std::vector<int> consultasEntre(int minimo, int maximo) const;
+
+	//Obter os NIFs dos clientes cujo nome começa por 'prefixo' (por ordem alfabética)
+	std::vector<int> procurarPorNome(const std::string& prefixo) const;
+
+	//Obter a listagem de clientes (uma cópia de verListagem())
 	std::string listagem() const;
 
-	//Getter
-	int getNumClientes() const { return numClientes; }
+	//Ver a listagem de clientes sem a copiar (cache mantida incrementalmente, ver CacheListagem).
+	// É uma VISTA: a referência só é válida até à próxima alteração do armário (para a guardar, usar listagem()).
+	// ATENÇÃO: põe em dia a cache ('mutable'), por isso NÃO pode ser chamada em várias
+	// threads ao mesmo tempo, mesmo sendo const (nem listagem()); para leitores concorrentes usar publicar()/ler()
+	const std::string& verListagem() const;
+
+	//Acrescentar a listagem de clientes a 'saida' (com clientes frios, não junta quentes e frios numa cópia;
+	// tal como verListagem(), não pode ser chamada em várias threads ao mesmo tempo)
+	void acrescentarListagem(std::string& saida) const;
+
+	//Obter a listagem de clientes por ordem alfabética do nome (nomes iguais por NIF)
+	std::string listagemPorNome() const;
+
+	//Obter a listagem de clientes por ordem crescente de NIF
+	std::string listagemPorNIF() const;
+
+	//Obter os NIFs entre minimo e maximo (inclusive), por ordem crescente
+	std::vector<int> nifsEntre(int minimo, int maximo) const;
+
+	//Passar para o armazém frio os clientes sem atividade nas últimas 'operacoes' operações (devolve quantos;
+	// não muda a ordem da listagem)
+	int arrefecer(unsigned long long operacoes);
+
+	//Getters
+	int getNumClientes() const { return clientes.getNumRegistos() + frios.getNumRegistos(); }
+	int getNumClientesFrios() const { return frios.getNumRegistos(); }
+	size_t getBytesFrios() const { return frios.getBytes(); }
 };
 
@@ -0,0 +1,233 @@
+#include "ArmazemFrio.h"
+#include <algorithm>
+
+namespace {
+
+	// Inteiro sem sinal em "varint" (o mesmo formato do RegistoAlteracoes)
+	void escreverVarint(std::string& saida, unsigned long long v) {
+		while (v >= 0x80) {
+			saida.push_back((char)(v | 0x80));
+			v >>= 7;
+		}
+		saida.push_back((char)v);
+	}
+
+	// Os blocos sao escritos so por esta classe, por isso nao se valida nada
+	unsigned long long lerVarint(const std::string& dados, size_t& pos) {
+		unsigned long long v = 0;
+		for (int deslocamento = 0; ; deslocamento += 7) {
+			unsigned char b = (unsigned char)dados[pos++];
+			v |= (unsigned long long)(b & 0x7f) << deslocamento;
+			if ((b & 0x80) == 0) {
+				return v;
+			}
+		}
+	}
+}
+
+ArmazemFrio::Vista ArmazemFrio::lerRegisto(const std::string& dados, size_t& pos, int& nif) {
+	nif = (int)((unsigned int)nif + (unsigned int)lerVarint(dados, pos));
+	int numConsultas = (int)lerVarint(dados, pos);
+	unsigned long long ordem = lerVarint(dados, pos);
+	size_t tamanho = (size_t)lerVarint(dados, pos);
+	std::string_view nome(dados.data() + pos, tamanho);
+	pos += tamanho;
+	return Vista{ nome, nif, numConsultas, ordem };
+}
+
+void ArmazemFrio::escreverBlocos(std::span<const Vista> registos, std::vector<int>& destinoPrimeiros, std::vector<Bloco>& destinoBlocos) {
+	for (size_t inicio = 0; inicio < registos.size(); inicio += REGISTOS_POR_BLOCO) {
+		size_t fim = std::min(registos.size(), inicio + REGISTOS_POR_BLOCO);
+
+		Bloco bloco{ (int)(fim - inicio), std::string() };
+		int anterior = registos[inicio].nif;
+		for (size_t i = inicio; i < fim; i++) {
+			const Vista& r = registos[i];
+			escreverVarint(bloco.dados, (unsigned int)r.nif - (unsigned int)anterior);
+			escreverVarint(bloco.dados, (unsigned int)r.numConsultas);
+			escreverVarint(bloco.dados, r.ordem);
+			escreverVarint(bloco.dados, (unsigned int)r.nome.size());
+			bloco.dados.append(r.nome);
+			anterior = r.nif;
+		}
+		bloco.dados.shrink_to_fit();
+
+		destinoPrimeiros.push_back(registos[inicio].nif);
+		destinoBlocos.push_back(std::move(bloco));
+	}
+}
+
+int ArmazemFrio::blocoDe(int nif) const {
+	return (int)(std::upper_bound(primeiros.begin(), primeiros.end(), nif) - primeiros.begin()) - 1;
+}
+
+std::optional<ArmazemFrio::Vista> ArmazemFrio::procurar(int nif) const {
+	int b = blocoDe(nif);
+	if (b < 0) {
+		return std::nullopt;
+	}
+
+	const Bloco& bloco = blocos[b];
+	int atual = primeiros[b];
+	size_t pos = 0;
+	for (int r = 0; r < bloco.numRegistos; r++) {
+		Vista v = lerRegisto(bloco.dados, pos, atual);
+		if (v.nif >= nif) {
+			return v.nif == nif ? std::optional<Vista>(v) : std::nullopt;
+		}
+	}
+	return std::nullopt;
+}
+
+// Descodifica o bloco do NIF e volta a codifica-lo sem esse registo
+// (um bloco que fica vazio desaparece)
+bool ArmazemFrio::retirar(int nif, Registo& registo) {
+	int b = blocoDe(nif);
+	if (b < 0) {
+		return false;
+	}
+
+	std::vector<Vista> ficam;
+	ficam.reserve(blocos[b].numRegistos);
+	bool encontrado = false;
+	int atual = primeiros[b];
+	size_t pos = 0;
+	for (int r = 0; r < blocos[b].numRegistos; r++) {
+		Vista v = lerRegisto(blocos[b].dados, pos, atual);
+		if (v.nif == nif) {
+			registo = Registo{ std::string(v.nome), v.nif, v.numConsultas, v.ordem };
+			encontrado = true;
+		}
+		else {
+			ficam.push_back(v);
+		}
+	}
+	if (!encontrado) {
+		return false;
+	}
+
+	if (ficam.empty()) {
+		primeiros.erase(primeiros.begin() + b);
+		blocos.erase(blocos.begin() + b);
+	}
+	else {
+		std::vector<int> novoPrimeiro;
+		std::vector<Bloco> novoBloco;
+		escreverBlocos(ficam, novoPrimeiro, novoBloco);
+		primeiros[b] = novoPrimeiro[0];
+		blocos[b] = std::move(novoBloco[0]);
+	}
+	numRegistos--;
+	return true;
+}
+
+// ============================================================================
+// ACRESCENTAR VARIOS
+// ============================================================================
+// Merge dos novos (ordenados) com os registos que ja estao no armazem, para
+// blocos novos:
+//   - Um bloco antigo sem novos NIFs no seu intervalo passa tal como esta
+//     (nao e descodificado; os registos pendentes antes dele fecham um
+//     bloco mais curto)
+//   - Os outros sao descodificados e juntos com os novos, e os registos
+//     resultantes sao codificados de novo, REGISTOS_POR_BLOCO de cada vez
+//
+//   primeiros -> [100][500][900]         novos -> {120, 950}
+//   bloco 0 (100..499) + 120  -> codificado de novo
+//   bloco 1 (500..899)        -> passa tal como esta
+//   bloco 2 (900..)   + 950   -> codificado de novo
+// ============================================================================
+void ArmazemFrio::acrescentarVarios(std::vector<Registo> novos) {
+	if (novos.empty()) {
+		return;
+	}
+	std::sort(novos.begin(), novos.end(), [](const Registo& a, const Registo& b) { return a.nif < b.nif; });
+
+	std::vector<int> novosPrimeiros;
+	std::vector<Bloco> novosBlocos;
+	novosPrimeiros.reserve(primeiros.size() + novos.size() / REGISTOS_POR_BLOCO + 1);
+	novosBlocos.reserve(primeiros.size() + novos.size() / REGISTOS_POR_BLOCO + 1);
+
+	// Registos a espera de formar um bloco (apontam para 'novos' ou para os blocos antigos)
+	std::vector<Vista> pendentes;
+	pendentes.reserve(REGISTOS_POR_BLOCO);
+	auto acrescentar = [&](const Vista& v) {
+		pendentes.push_back(v);
+		if ((int)pendentes.size() == REGISTOS_POR_BLOCO) {
+			escreverBlocos(pendentes, novosPrimeiros, novosBlocos);
+			pendentes.clear();
+		}
+	};
+
+	size_t j = 0;
+	for (size_t b = 0; b < blocos.size(); b++) {
+		bool ultimo = b + 1 == blocos.size();
+		bool semNovos = j == novos.size() || (!ultimo && novos[j].nif >= primeiros[b + 1]);
+		if (semNovos) {
+			// Os pendentes fecham um bloco mais curto, para este nao ter de ser descodificado
+			escreverBlocos(pendentes, novosPrimeiros, novosBlocos);
+			pendentes.clear();
+			novosPrimeiros.push_back(primeiros[b]);
+			novosBlocos.push_back(std::move(blocos[b]));
+			continue;
+		}
+
+		int atual = primeiros[b];
+		size_t pos = 0;
+		for (int r = 0; r < blocos[b].numRegistos; r++) {
+			Vista v = lerRegisto(blocos[b].dados, pos, atual);
+			while (j < novos.size() && novos[j].nif < v.nif) {
+				acrescentar(Vista{ novos[j].nome, novos[j].nif, novos[j].numConsultas, novos[j].ordem });
+				j++;
+			}
+			acrescentar(v);
+		}
+		// Novos antes do bloco seguinte (tambem ficam neste ponto do merge)
+		while (j < novos.size() && (ultimo || novos[j].nif < primeiros[b + 1])) {
+			acrescentar(Vista{ novos[j].nome, novos[j].nif, novos[j].numConsultas, novos[j].ordem });
+			j++;
+		}
+	}
+	for (; j < novos.size(); j++) {
+		acrescentar(Vista{ novos[j].nome, novos[j].nif, novos[j].numConsultas, novos[j].ordem });
+	}
+	escreverBlocos(pendentes, novosPrimeiros, novosBlocos);
+
+	primeiros = std::move(novosPrimeiros);
+	blocos = std::move(novosBlocos);
+	numRegistos += (int)novos.size();
+}
+
+std::vector<int> ArmazemFrio::nifsEntre(int minimo, int maximo) const {
+	std::vector<int> resultado;
+	for (size_t b = std::max(blocoDe(minimo), 0); b < blocos.size() && primeiros[b] <= maximo; b++) {
+		int atual = primeiros[b];
+		size_t pos = 0;
+		for (int r = 0; r < blocos[b].numRegistos; r++) {
+			Vista v = lerRegisto(blocos[b].dados, pos, atual);
+			if (v.nif > maximo) {
+				break;
+			}
+			if (v.nif >= minimo) {
+				resultado.push_back(v.nif);
+			}
+		}
+	}
+	return resultado;
+}
+
+void ArmazemFrio::limpar() {
+	primeiros.clear();
+	primeiros.shrink_to_fit();
+	blocos.clear();
+	blocos.shrink_to_fit();
+	numRegistos = 0;
+}
+
+size_t ArmazemFrio::getBytes() const {
+	size_t bytes = primeiros.capacity() * sizeof(int) + blocos.capacity() * sizeof(Bloco);
+	for (const Bloco& bloco : blocos) {
+		bytes += bloco.dados.capacity();
+	}
+	return bytes;
+}
@@ -0,0 +1,120 @@
+#pragma once
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// ============================================================================
+// ARMAZEM FRIO (clientes inativos, comprimidos)
+// ============================================================================
+// Guarda clientes que ha muito tempo nao tem consultas sem um objeto Cliente
+// por cada um: os registos ficam ordenados por NIF, em blocos de ate
+// REGISTOS_POR_BLOCO, cada bloco uma so string com os registos seguidos.
+//
+// Cada registo e codificado em "varint" (7 bits por byte, ver
+// RegistoAlteracoes), com o NIF como diferenca para o NIF anterior do bloco:
+//
+//   primeiros -> [ 100200300 ][ 100207411 ] ...
+//   blocos    -> [ d=0 c=3 o=12 t=4 "Joao" | d=17 c=0 o=5 t=5 "Maria" | ... ]
+//                   d = NIF - NIF anterior (0 no primeiro), c = consultas,
+//                   o = lugar do cliente na listagem do armario (ver
+//                   ArmarioFichas::arrefecer), t = tamanho do nome, seguido
+//                   dos caracteres do nome
+//
+// Um registo tipico (nome de ~25 caracteres) ocupa ~33 bytes, contra ~200
+// de um cliente quente (Cliente e nome no heap, ponteiro e chave no Armario,
+// linha da listagem).
+//
+// Procurar um NIF = pesquisa binaria em 'primeiros' + descodificar no maximo
+// um bloco. Os nomes nao sao comprimidos, por isso as vistas devolvidas
+// apontam para dentro do bloco (sem copias) ate a proxima alteracao.
+//
+// Exemplo de uso:
+//   ArmazemFrio frios;
+//   frios.acrescentarVarios({ { "Maria", 222, 3, 1 }, { "Joao", 111, 0, 2 } });
+//   auto v = frios.procurar(222);     // v->nome == "Maria", v->numConsultas == 3
+//
+//   ArmazemFrio::Registo r;
+//   frios.retirar(111, r);            // r = { "Joao", 111, 0, 2 }, deixa de estar no armazem
+// ============================================================================
+class ArmazemFrio
+{
+public:
+	// Um registo completo (para entrar ou sair do armazem)
+	struct Registo {
+		std::string nome;
+		int nif;
+		int numConsultas;
+		unsigned long long ordem;	// lugar na listagem (guardado, nao interpretado)
+	};
+
+	// Um registo visto dentro do armazem (o nome aponta para o bloco)
+	struct Vista {
+		std::string_view nome;
+		int nif;
+		int numConsultas;
+		unsigned long long ordem;
+	};
+
+private:
+	static const int REGISTOS_POR_BLOCO = 64;
+
+	struct Bloco {
+		int numRegistos;
+		std::string dados;		// registos codificados, por ordem de NIF
+	};
+
+	std::vector<int> primeiros;		// primeiros[b] = NIF do primeiro registo do bloco b (ordenados)
+	std::vector<Bloco> blocos;
+	int numRegistos;
+
+	//Bloco onde o NIF estaria (-1 se for menor do que todos)
+	int blocoDe(int nif) const;
+
+	//Descodificar o registo em dados[pos] (nif entra com o NIF anterior e sai com o deste)
+	static Vista lerRegisto(const std::string& dados, size_t& pos, int& nif);
+
+	//Codificar 'registos' (ordenados) em blocos novos, no fim de 'destinoPrimeiros'/'destinoBlocos'
+	static void escreverBlocos(std::span<const Vista> registos, std::vector<int>& destinoPrimeiros, std::vector<Bloco>& destinoBlocos);
+
+public:
+	//Construtor (vazio)
+	ArmazemFrio() : numRegistos(0) {}
+
+	//Procurar um NIF (vazio se nao estiver no armazem)
+	std::optional<Vista> procurar(int nif) const;
+	bool contem(int nif) const { return procurar(nif).has_value(); }
+
+	//Tirar o registo com este NIF do armazem, para 'registo' (false se nao existir)
+	bool retirar(int nif, Registo& registo);
+
+	//Acrescentar registos (NIFs que ainda nao estao no armazem)
+	void acrescentarVarios(std::vector<Registo> novos);
+
+	//NIFs entre minimo e maximo (inclusive), por ordem crescente
+	std::vector<int> nifsEntre(int minimo, int maximo) const;
+
+	//Percorrer todos os registos por ordem de NIF: f(const Vista&)
+	template <typename F>
+	void paraCada(F&& f) const;
+
+	//Apagar tudo
+	void limpar();
+
+	//Getters
+	int getNumRegistos() const { return numRegistos; }
+	size_t getBytes() const;	// memoria ocupada (aproximada)
+};
+
+template <typename F>
+void ArmazemFrio::paraCada(F&& f) const {
+	for (size_t b = 0; b < blocos.size(); b++) {
+		const Bloco& bloco = blocos[b];
+		int nif = primeiros[b];
+		size_t pos = 0;
+		for (int r = 0; r < bloco.numRegistos; r++) {
+			f(lerRegisto(bloco.dados, pos, nif));
+		}
+	}
+}
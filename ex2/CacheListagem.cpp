@@ -0,0 +1,170 @@
+#include "CacheListagem.h"
+#include <algorithm>
+
+// Construtor Default
+CacheListagem::CacheListagem() : bytesLinhas(0), emOrdem(true) {}
+
+void CacheListagem::acrescentar(const std::string& linha, int tamanho) {
+	// A linha nova vai para o fim do texto, que e tambem o fim das ranhuras
+	// (se o texto estava por ordem, continua)
+	inicio.push_back(texto.size());
+	comprimento.push_back((int)linha.size());
+	tamanhoNome.push_back(tamanho);
+	texto += linha;
+	bytesLinhas += linha.size();
+}
+
+void CacheListagem::atualizar(int pos, const std::string& linha) {
+	size_t antigo = (size_t)comprimento[pos];
+	if (linha.size() == antigo) {
+		texto.replace(inicio[pos], antigo, linha);	// no lugar
+		return;
+	}
+
+	bytesLinhas = bytesLinhas - antigo + linha.size();
+	comprimento[pos] = (int)linha.size();
+	if (inicio[pos] + antigo == texto.size()) {
+		// A linha e a ultima do texto: corta-se e escreve-se de novo
+		texto.resize(inicio[pos]);
+		texto += linha;
+		return;
+	}
+
+	// A linha passa para o fim do texto; o lugar antigo fica por usar ate ao proximo obter()
+	inicio[pos] = texto.size();
+	texto += linha;
+	emOrdem = false;
+	limitarPorUsar();
+}
+
+// ============================================================================
+// REMOVER
+// ============================================================================
+// Espelha o swap-and-pop do ArmarioFichas::apagarCliente:
+//   ranhuras -> [L0][L1][L2][L3]     remover(1)
+//   ranhuras -> [L0][L3][L2]         L3 passa para a ranhura 1
+//
+//   - L3 com o comprimento de L1: e copiada para o lugar de L1 e o texto e
+//     cortado no inicio de L3 (continua por ordem)
+//   - Senao a ranhura 1 passa a apontar para L3 (no fim do texto) e o lugar
+//     de L1 fica por usar ate ao proximo obter()
+// ============================================================================
+void CacheListagem::remover(int pos) {
+	int ultima = (int)inicio.size() - 1;
+	bytesLinhas -= (size_t)comprimento[pos];
+
+	// Lugar no texto que deixa de ser usado
+	size_t inicioLivre = inicio[pos];
+	size_t tamanhoLivre = (size_t)comprimento[pos];
+	if (pos != ultima) {
+		if (comprimento[ultima] == comprimento[pos]) {
+			std::copy_n(texto.begin() + inicio[ultima], comprimento[ultima], texto.begin() + inicio[pos]);
+			inicioLivre = inicio[ultima];
+		}
+		else {
+			inicio[pos] = inicio[ultima];
+			comprimento[pos] = comprimento[ultima];
+			emOrdem = false;
+		}
+		tamanhoNome[pos] = tamanhoNome[ultima];
+	}
+	inicio.pop_back();
+	comprimento.pop_back();
+	tamanhoNome.pop_back();
+
+	// No fim do texto, o lugar livre e simplesmente cortado
+	if (inicioLivre + tamanhoLivre == texto.size()) {
+		texto.resize(inicioLivre);
+	}
+	limitarPorUsar();
+}
+
+// Espelha o Armario::removerMarcados: as ranhuras que ficam sao juntas pela
+// mesma ordem e o texto e logo compactado (quase todas as linhas mudaram de
+// sitio, e os lugares das apagadas sao libertados ja)
+void CacheListagem::removerMarcadas(std::span<const char> marcados) {
+	size_t j = 0;
+	for (size_t i = 0; i < inicio.size(); i++) {
+		if (marcados[i] == 0) {
+			inicio[j] = inicio[i];
+			comprimento[j] = comprimento[i];
+			tamanhoNome[j] = tamanhoNome[i];
+			j++;
+		}
+		else {
+			bytesLinhas -= (size_t)comprimento[i];
+		}
+	}
+	if (j == inicio.size()) {
+		return;
+	}
+	inicio.resize(j);
+	comprimento.resize(j);
+	tamanhoNome.resize(j);
+	inicio.shrink_to_fit();
+	comprimento.shrink_to_fit();
+	tamanhoNome.shrink_to_fit();
+	compactar();
+}
+
+void CacheListagem::limpar() {
+	texto.clear();
+	inicio.clear();
+	comprimento.clear();
+	tamanhoNome.clear();
+	bytesLinhas = 0;
+	emOrdem = true;
+}
+
+// Texto novo com as linhas pela ordem das ranhuras. As ranhuras seguidas
+// cujas linhas ja estavam seguidas no texto antigo vao num so bloco:
+//
+//   texto  -> [L0][L1][..][L3][L2'][L1']     ranhuras 0..3 (L1 e L2 mudaram)
+//   novo   -> [L0][L1'][L2'][L3]
+//             |--|  +   +   |--|   (L0, depois L1', L2' e L3 em blocos)
+void CacheListagem::compactar() {
+	std::string novo;
+	novo.reserve(bytesLinhas);
+
+	size_t n = inicio.size();
+	size_t i = 0;
+	while (i < n) {
+		size_t j = i + 1;
+		size_t fim = inicio[i] + (size_t)comprimento[i];
+		while (j < n && inicio[j] == fim) {
+			fim += (size_t)comprimento[j];
+			j++;
+		}
+		size_t desvio = novo.size() - inicio[i];	// sem sinal: soma modular, pode "recuar"
+		novo.append(texto, inicio[i], fim - inicio[i]);
+		for (size_t k = i; k < j; k++) {
+			inicio[k] += desvio;
+		}
+		i = j;
+	}
+
+	texto = std::move(novo);
+	emOrdem = true;
+}
+
+// Os lugares por usar nunca passam de metade das linhas: cada compactacao
+// custa O(n), mas so acontece depois de O(n) bytes reescritos
+void CacheListagem::limitarPorUsar() {
+	if (texto.size() - bytesLinhas > bytesLinhas / 2) {
+		compactar();
+	}
+}
+
+// ============================================================================
+// OBTER
+// ============================================================================
+// Se alguma linha mudou de sitio desde a ultima vez, o texto e compactado
+// (ver compactar); as vistas devolvidas antes por nome()/linha() deixam de
+// ser validas.
+// ============================================================================
+const std::string& CacheListagem::obter() {
+	if (!emOrdem) {
+		compactar();
+	}
+	return texto;
+}
@@ -0,0 +1,76 @@
+#pragma once
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// ============================================================================
+// CACHE DA LISTAGEM
+// ============================================================================
+// Guarda o texto completo da listagem ja formatado, com uma "ranhura" (linha)
+// por cliente, na MESMA posicao que o cliente ocupa no array 'clientes'.
+//
+// Cada linha existe uma so vez, dentro de 'texto'; cada ranhura guarda so
+// onde comeca a sua linha e o seu comprimento:
+//
+//   texto -> "Joao / 111 / 9\nMaria / 222 / 0\n"
+//   inicio -> [0][15]     comprimento -> [15][16]
+//
+// O ArmarioFichas avisa a cache sempre que um cliente e acrescentado, apagado
+// ou alterado, e a cache so formata a linha desse cliente:
+//   - Linha com o mesmo comprimento: reescrita no lugar, O(1)
+//   - Linha com outro comprimento (ex: "Joao / 111 / 9" -> "Joao / 111 / 10"):
+//     escrita no fim do texto, e o lugar antigo fica por usar
+//   - remover(): a ultima linha passa para a ranhura da apagada (copiada para
+//     o lugar dela se tiver o mesmo comprimento, senao a ranhura aponta para
+//     o sitio onde ela ja esta)
+//
+// Enquanto nenhuma linha mudar de sitio, o texto e a listagem e obter() e
+// O(1). Depois, obter() volta a juntar as linhas pela ordem das ranhuras:
+// O(n) bytes copiados, mas as linhas que continuam seguidas vao em blocos
+// (nenhuma linha volta a ser formatada). Se os lugares por usar passarem de
+// metade do texto, isto e feito logo (o texto nunca passa de ~1.5x a listagem).
+//
+// Cada linha comeca pelo nome do cliente, por isso a cache tambem serve de
+// armazenamento para ver o nome sem o copiar (ver nome()).
+// ============================================================================
+class CacheListagem
+{
+	std::string texto;					// as linhas das ranhuras (pela ordem das ranhuras e sem lugares por usar se 'emOrdem')
+	std::vector<size_t> inicio;			// inicio[i] = deslocamento da linha i em 'texto'
+	std::vector<int> comprimento;		// comprimento[i] = numero de caracteres da linha i (com o '\n')
+	std::vector<int> tamanhoNome;		// tamanhoNome[i] = numero de caracteres do nome no inicio da linha i
+	size_t bytesLinhas;					// soma de 'comprimento' (o resto de 'texto' sao lugares por usar)
+	bool emOrdem;						// 'texto' e exatamente linha 0 + linha 1 + ... (a listagem)
+
+	void compactar();
+	void limitarPorUsar();
+
+public:
+	//Construtor
+	CacheListagem();
+
+	//Novo cliente no fim do array
+	void acrescentar(const std::string& linha, int tamanhoNome);
+
+	//Cliente na posicao 'pos' foi alterado
+	void atualizar(int pos, const std::string& linha);
+
+	//Cliente na posicao 'pos' foi apagado (swap-and-pop, tal como no ArmarioFichas)
+	void remover(int pos);
+
+	//Clientes com marcados[pos] != 0 foram apagados de uma vez (os outros ficam pela mesma ordem)
+	void removerMarcadas(std::span<const char> marcados);
+
+	//Apagar todas as ranhuras
+	void limpar();
+
+	//Ver o nome do cliente na posicao 'pos' (valido ate a proxima alteracao ou ao proximo obter())
+	std::string_view nome(int pos) const { return std::string_view(texto.data() + inicio[pos], tamanhoNome[pos]); }
+
+	//Ver a linha do cliente na posicao 'pos' (com o '\n'; valida ate a proxima alteracao ou ao proximo obter())
+	std::string_view linha(int pos) const { return std::string_view(texto.data() + inicio[pos], comprimento[pos]); }
+
+	//Obter a listagem atualizada (pode mudar as linhas de sitio no texto)
+	const std::string& obter();
+};
@@ -0,0 +1,88 @@
+#include "FiltroBloom.h"
+
+// Construtor Default
+FiltroBloom::FiltroBloom() : numBlocos(0), capacidade(0), inseridos(0) {}
+
+// Mistura os bits do NIF (finalizador do MurmurHash3), para que NIFs
+// seguidos (123456789, 123456790, ...) caiam em blocos e bits diferentes
+uint64_t FiltroBloom::espalhar(uint64_t h) {
+	h ^= h >> 33;
+	h *= 0xff51afd7ed558ccdULL;
+	h ^= h >> 33;
+	h *= 0xc4ceb9fe1a85ec53ULL;
+	h ^= h >> 33;
+	return h;
+}
+
+void FiltroBloom::dimensionar(int capacidadeP) {
+	capacidade = capacidadeP;
+	inseridos = 0;
+
+	// Numero de blocos necessario para ter BITS_POR_NIF bits por NIF (arredondado para cima)
+	numBlocos = ((uint64_t)capacidade * BITS_POR_NIF + 511) / 512;
+	palavras.assign(numBlocos * PALAVRAS_POR_BLOCO, 0);
+}
+
+// ============================================================================
+// ACRESCENTAR / PODE CONTER
+// ============================================================================
+// O hash de 64 bits e usado assim:
+//   - 32 bits altos: escolhem o bloco ((h * numBlocos) >> 32, mais rapido que '%')
+//   - os K bits a acender dentro do bloco vem de janelas de 9 bits (0..511)
+//     SEM sobreposicao: 7 janelas de 'h * constante' (63 bits) e a 8a de uma
+//     segunda mistura de h. Janelas sobrepostas dariam bits correlacionados
+//     e mais falsos positivos.
+//
+// Falsos positivos medidos com o filtro cheio (16 bits por NIF): ~0.09%
+// (ex2_bench --bloom).
+// ============================================================================
+uint64_t FiltroBloom::inicioBloco(uint64_t h) const {
+	return (((h >> 32) * numBlocos) >> 32) * PALAVRAS_POR_BLOCO;
+}
+
+void FiltroBloom::bitsNoBloco(uint64_t h, int bits[K]) {
+	uint64_t janelas = h * 0x9e3779b97f4a7c15ULL;
+	int usados = 0;
+	for (int i = 0; i < K; i++) {
+		if (usados + 9 > 64) {
+			janelas = espalhar(h ^ 0x5851f42d4c957f2dULL);
+			usados = 0;
+		}
+		bits[i] = (int)((janelas >> usados) & 511);
+		usados += 9;
+	}
+}
+
+void FiltroBloom::acrescentar(int nif) {
+	if (!ativo()) {
+		return;
+	}
+
+	uint64_t h = espalhar((uint32_t)nif);
+	uint64_t* bloco = &palavras[inicioBloco(h)];
+	int bits[K];
+	bitsNoBloco(h, bits);
+
+	for (int bit : bits) {
+		bloco[bit >> 6] |= 1ULL << (bit & 63);
+	}
+	inseridos++;
+}
+
+bool FiltroBloom::podeConter(int nif) const {
+	if (!ativo()) {
+		return true;	// desativado: "talvez" para tudo
+	}
+
+	uint64_t h = espalhar((uint32_t)nif);
+	const uint64_t* bloco = &palavras[inicioBloco(h)];
+	int bits[K];
+	bitsNoBloco(h, bits);
+
+	for (int bit : bits) {
+		if ((bloco[bit >> 6] & (1ULL << (bit & 63))) == 0) {
+			return false;
+		}
+	}
+	return true;
+}
@@ -0,0 +1,56 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+// ============================================================================
+// FILTRO DE BLOOM (por blocos)
+// ============================================================================
+// Responde a "este NIF PODE estar no armario?" em poucos nanossegundos:
+//   - podeConter(nif) == false -> o NIF de certeza que NAO esta no armario
+//   - podeConter(nif) == true  -> talvez esteja (e preciso procurar)
+//
+// Cada NIF acende K bits dentro de UM so bloco de 512 bits (64 bytes, uma
+// linha de cache), por isso cada pergunta le uma unica linha de cache.
+//
+//   blocos -> [bloco 0: 512 bits][bloco 1: 512 bits] ... [bloco n-1]
+//                                      ^
+//                     hash(nif) escolhe o bloco e os K bits dentro dele
+//
+// Nao e possivel apagar NIFs: um NIF apagado continua a dar "talvez" ate o
+// filtro ser reconstruido. Por isso o filtro conta as insercoes desde a
+// ultima reconstrucao e diz quando esta cheio().
+//
+// Um filtro sem blocos esta desativado e responde sempre "talvez".
+// ============================================================================
+class FiltroBloom
+{
+	static const int PALAVRAS_POR_BLOCO = 8;	// 8 x 64 bits = 512 bits
+	static const int BITS_POR_NIF = 16;			// ~0.1% de falsos positivos com K = 8
+	static const int K = 8;						// bits acesos por NIF
+
+	std::vector<uint64_t> palavras;	// numBlocos * PALAVRAS_POR_BLOCO
+	uint64_t numBlocos;
+	int capacidade;					// numero de NIFs para que foi dimensionado
+	int inseridos;					// NIFs inseridos desde o ultimo dimensionar()
+
+	static uint64_t espalhar(uint64_t h);
+	static void bitsNoBloco(uint64_t h, int bits[K]);	// os K bits (0..511) a acender no bloco
+	uint64_t inicioBloco(uint64_t h) const;
+
+public:
+	//Construtor (filtro desativado)
+	FiltroBloom();
+
+	//Apagar tudo e dimensionar para 'capacidade' NIFs (0 desativa o filtro)
+	void dimensionar(int capacidade);
+
+	//Acrescentar um NIF
+	void acrescentar(int nif);
+
+	//false -> de certeza que o NIF nao foi acrescentado
+	bool podeConter(int nif) const;
+
+	//Getters
+	bool ativo() const { return numBlocos != 0; }
+	bool cheio() const { return inseridos >= capacidade; }
+};
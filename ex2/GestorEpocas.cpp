@@ -0,0 +1,117 @@
+#include "GestorEpocas.h"
+#include <stdexcept>
+
+// Estado de cada thread: em que posicao do gestor esta e quantas leituras
+// tem abertas (entrar() dentro de entrar() so conta a primeira).
+// Quando a thread termina, o destrutor devolve a posicao.
+class RegistoThread {
+public:
+	GestorEpocas* gestor = nullptr;
+	int posicao = -1;
+	int profundidade = 0;
+
+	~RegistoThread() {
+		if (posicao >= 0) {
+			gestor->posicoes[posicao].epoca.store(0);
+			gestor->posicoes[posicao].ocupada.store(false);
+		}
+	}
+};
+
+static thread_local RegistoThread registoThread;
+
+// Construtor (a epoca 0 esta reservada para "fora de uma leitura")
+GestorEpocas::GestorEpocas() : epocaGlobal(1) {}
+
+GestorEpocas::~GestorEpocas() {
+	std::lock_guard<std::mutex> lock(mutexRetirados);
+	libertarRetirados(true);
+}
+
+GestorEpocas& GestorEpocas::global() {
+	static GestorEpocas gestor;
+	return gestor;
+}
+
+// Na primeira leitura de cada thread, ocupa uma posicao livre
+int GestorEpocas::posicaoDaThread() {
+	if (registoThread.posicao < 0) {
+		for (int i = 0; i < MAX_LEITORES; i++) {
+			bool livre = false;
+			if (posicoes[i].ocupada.compare_exchange_strong(livre, true)) {
+				registoThread.gestor = this;
+				registoThread.posicao = i;
+				break;
+			}
+		}
+		if (registoThread.posicao < 0) {
+			throw std::runtime_error("GestorEpocas: demasiadas threads leitoras");
+		}
+	}
+	return registoThread.posicao;
+}
+
+// ============================================================================
+// ENTRAR / SAIR
+// ============================================================================
+// O leitor escreve a epoca atual na sua posicao ANTES de ler o ponteiro
+// partilhado. O escritor muda o ponteiro ANTES de avancar a epoca e de ver
+// as posicoes. Com operacoes seq_cst, pelo menos um dos dois ve o outro:
+//   - ou o escritor ve o leitor (e nao apaga o objeto antigo)
+//   - ou o leitor ja ve o ponteiro novo (e nunca chega a ver o antigo)
+// ============================================================================
+void GestorEpocas::entrar() {
+	if (registoThread.profundidade++ > 0) {
+		return;
+	}
+	int p = posicaoDaThread();
+	posicoes[p].epoca.store(epocaGlobal.load());
+}
+
+void GestorEpocas::sair() {
+	if (--registoThread.profundidade > 0) {
+		return;
+	}
+	posicoes[registoThread.posicao].epoca.store(0);
+}
+
+void GestorEpocas::retirarObjeto(void* objeto, void (*apagar)(void*)) {
+	std::lock_guard<std::mutex> lock(mutexRetirados);
+	retirados.push_back(Retirado{ objeto, apagar, epocaGlobal.fetch_add(1) });
+	libertarRetirados(false);
+}
+
+void GestorEpocas::recolher() {
+	std::lock_guard<std::mutex> lock(mutexRetirados);
+	libertarRetirados(false);
+}
+
+// Apaga os objetos retirados antes da epoca do leitor ativo mais antigo
+// (chamado com 'mutexRetirados' fechado)
+void GestorEpocas::libertarRetirados(bool todos) {
+	uint64_t maisAntiga = UINT64_MAX;
+	if (!todos) {
+		for (int i = 0; i < MAX_LEITORES; i++) {
+			uint64_t e = posicoes[i].epoca.load();
+			if (e != 0 && e < maisAntiga) {
+				maisAntiga = e;
+			}
+		}
+	}
+
+	size_t ficam = 0;
+	for (size_t i = 0; i < retirados.size(); i++) {
+		if (retirados[i].epoca < maisAntiga) {
+			retirados[i].apagar(retirados[i].objeto);
+		}
+		else {
+			retirados[ficam++] = retirados[i];
+		}
+	}
+	retirados.resize(ficam);
+}
+
+int GestorEpocas::getNumRetirados() {
+	std::lock_guard<std::mutex> lock(mutexRetirados);
+	return (int)retirados.size();
+}
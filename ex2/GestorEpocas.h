@@ -0,0 +1,88 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+// ============================================================================
+// GESTOR DE EPOCAS (reclamacao de memoria baseada em epocas)
+// ============================================================================
+// Problema: um escritor substitui um objeto partilhado (ex: a versao publicada
+// de um ArmarioFichas) por outro. Quando pode apagar o antigo? Pode haver
+// leitores noutras threads que ainda o estao a ler.
+//
+// Solucao:
+//   - Existe uma "epoca" global (um contador que so aumenta)
+//   - Um leitor, antes de ler, anuncia a epoca em que entrou (entrar()) e,
+//     quando acaba, anuncia que saiu (sair())
+//   - O escritor, em vez de apagar, "retira" o objeto antigo, que fica
+//     guardado com a epoca em que foi retirado, e avanca a epoca global
+//   - Um objeto retirado na epoca r so e apagado quando TODOS os leitores
+//     ativos entraram depois de r (ja nao o podem ter visto)
+//
+//   epoca:     5          6          7
+//   leitor A:  [---a ler---------]                 (entrou na 5)
+//   escritor:        retira V1 (r=5)
+//   leitor B:                   [--a ler--]        (entrou na 6, ja ve V2)
+//                                        ^ A saiu: V1 pode ser apagado
+//
+// Os leitores nunca esperam nem bloqueiam o escritor (so escrevem um numero
+// na sua posicao). Existe um unico gestor para todo o programa (global()).
+// ============================================================================
+class GestorEpocas
+{
+	static const int MAX_LEITORES = 128;	// threads leitoras registadas em simultaneo
+
+	// Uma posicao por thread leitora, cada uma na sua linha de cache
+	// (para que threads diferentes nao escrevam na mesma linha)
+	struct alignas(64) Posicao {
+		std::atomic<uint64_t> epoca{ 0 };		// 0 = fora de uma leitura
+		std::atomic<bool> ocupada{ false };
+	};
+
+	struct Retirado {
+		void* objeto;
+		void (*apagar)(void*);
+		uint64_t epoca;
+	};
+
+	std::atomic<uint64_t> epocaGlobal;
+	Posicao posicoes[MAX_LEITORES];
+
+	std::mutex mutexRetirados;			// protege 'retirados' (so usado por escritores)
+	std::vector<Retirado> retirados;
+
+	GestorEpocas();
+
+	int posicaoDaThread();
+	void libertarRetirados(bool todos);
+
+	friend class RegistoThread;
+
+public:
+	GestorEpocas(const GestorEpocas&) = delete;
+	GestorEpocas& operator=(const GestorEpocas&) = delete;
+
+	//Destrutor (apaga tudo o que ainda estiver retirado)
+	~GestorEpocas();
+
+	//O gestor unico do programa
+	static GestorEpocas& global();
+
+	//Leitor: inicio e fim de uma leitura (podem ser encaixadas na mesma thread)
+	void entrar();
+	void sair();
+
+	//Escritor: o objeto deixou de estar acessivel a novos leitores; sera apagado quando for seguro
+	template <typename T>
+	void retirar(const T* objeto) {
+		retirarObjeto((void*)objeto, [](void* p) { delete (const T*)p; });
+	}
+	void retirarObjeto(void* objeto, void (*apagar)(void*));
+
+	//Apagar o que ja for seguro apagar
+	void recolher();
+
+	//Getter (estatisticas)
+	int getNumRetirados();
+};
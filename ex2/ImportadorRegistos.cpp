@@ -0,0 +1,269 @@
+#include "ImportadorRegistos.h"
+#include "LeituraTexto.h"
+#include <chrono>
+#include <cstring>
+#include <functional>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+	// ========================================================================
+	// FICHEIRO MAPEADO EM MEMORIA
+	// ========================================================================
+	// O sistema operativo "mostra" o ficheiro como se fosse um array de char,
+	// carregando as paginas a medida que sao lidas. O destrutor desfaz o
+	// mapeamento (RAII), mesmo que a importacao lance uma excecao.
+	// ========================================================================
+	class FicheiroMapeado {
+		const char* dados;
+		size_t tamanho;
+#ifdef _WIN32
+		HANDLE ficheiro;
+		HANDLE mapeamento;
+#else
+		int ficheiro;
+#endif
+
+	public:
+		FicheiroMapeado(const std::string& caminho);
+		~FicheiroMapeado();
+
+		FicheiroMapeado(const FicheiroMapeado&) = delete;
+		FicheiroMapeado& operator=(const FicheiroMapeado&) = delete;
+
+		const char* obtemDados() const { return dados; }
+		size_t obtemTamanho() const { return tamanho; }
+	};
+
+#ifdef _WIN32
+	FicheiroMapeado::FicheiroMapeado(const std::string& caminho) : dados(nullptr), tamanho(0), ficheiro(INVALID_HANDLE_VALUE), mapeamento(nullptr) {
+		ficheiro = CreateFileA(caminho.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+		if (ficheiro == INVALID_HANDLE_VALUE) {
+			throw std::runtime_error("Nao foi possivel abrir " + caminho);
+		}
+
+		LARGE_INTEGER t;
+		if (!GetFileSizeEx(ficheiro, &t)) {
+			CloseHandle(ficheiro);
+			throw std::runtime_error("Nao foi possivel obter o tamanho de " + caminho);
+		}
+		tamanho = (size_t)t.QuadPart;
+		if (tamanho == 0) {
+			return;	// ficheiro vazio: nao ha nada para mapear
+		}
+
+		mapeamento = CreateFileMappingA(ficheiro, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		if (mapeamento != nullptr) {
+			dados = (const char*)MapViewOfFile(mapeamento, FILE_MAP_READ, 0, 0, 0);
+		}
+		if (dados == nullptr) {
+			if (mapeamento != nullptr) {
+				CloseHandle(mapeamento);
+			}
+			CloseHandle(ficheiro);
+			throw std::runtime_error("Nao foi possivel mapear " + caminho);
+		}
+	}
+
+	FicheiroMapeado::~FicheiroMapeado() {
+		if (dados != nullptr) {
+			UnmapViewOfFile(dados);
+		}
+		if (mapeamento != nullptr) {
+			CloseHandle(mapeamento);
+		}
+		CloseHandle(ficheiro);
+	}
+#else
+	FicheiroMapeado::FicheiroMapeado(const std::string& caminho) : dados(nullptr), tamanho(0), ficheiro(-1) {
+		ficheiro = open(caminho.c_str(), O_RDONLY);
+		if (ficheiro < 0) {
+			throw std::runtime_error("Nao foi possivel abrir " + caminho);
+		}
+
+		struct stat info;
+		if (fstat(ficheiro, &info) != 0) {
+			close(ficheiro);
+			throw std::runtime_error("Nao foi possivel obter o tamanho de " + caminho);
+		}
+		tamanho = (size_t)info.st_size;
+		if (tamanho == 0) {
+			return;	// ficheiro vazio: nao ha nada para mapear
+		}
+
+		void* p = mmap(nullptr, tamanho, PROT_READ, MAP_PRIVATE, ficheiro, 0);
+		if (p == MAP_FAILED) {
+			close(ficheiro);
+			throw std::runtime_error("Nao foi possivel mapear " + caminho);
+		}
+		madvise(p, tamanho, MADV_SEQUENTIAL);
+		dados = (const char*)p;
+	}
+
+	FicheiroMapeado::~FicheiroMapeado() {
+		if (dados != nullptr) {
+			munmap((void*)dados, tamanho);
+		}
+		close(ficheiro);
+	}
+#endif
+
+	// Ultima ocorrencia de 'c' em [inicio, fim), ou nullptr
+	const char* procurarAtras(const char* inicio, const char* fim, char c) {
+		while (fim > inicio) {
+			fim--;
+			if (*fim == c) {
+				return fim;
+			}
+		}
+		return nullptr;
+	}
+
+	// Resultado de uma thread: os registos do seu pedaco (o nome aponta para o ficheiro mapeado)
+	struct Pedaco {
+		const char* inicio;
+		const char* fim;
+		std::vector<ArmarioFichas::RegistoCliente> registos;
+		long long linhas = 0;
+		long long invalidas = 0;
+	};
+
+	// ========================================================================
+	// LER PEDACO
+	// ========================================================================
+	// Cada linha e dividida pelos DOIS ULTIMOS ';' (o nome pode ter ';'):
+	//
+	//   Joao Silva;123456789;4\r\n
+	//   |---nome--| |--nif--| c
+	//
+	// NIF e consultas so com digitos (sem sinal), consultas ate ArmarioFichas::MAX_CONSULTAS.
+	// ========================================================================
+	void lerPedaco(Pedaco& pedaco) {
+		const char* p = pedaco.inicio;
+
+		while (p < pedaco.fim) {
+			const char* fimLinha = (const char*)memchr(p, '\n', pedaco.fim - p);
+			if (fimLinha == nullptr) {
+				fimLinha = pedaco.fim;
+			}
+			const char* proxima = fimLinha < pedaco.fim ? fimLinha + 1 : fimLinha;
+
+			if (fimLinha > p && fimLinha[-1] == '\r') {
+				fimLinha--;
+			}
+			if (fimLinha == p) {
+				p = proxima;	// linha vazia
+				continue;
+			}
+			pedaco.linhas++;
+
+			const char* sep2 = procurarAtras(p, fimLinha, ';');
+			const char* sep1 = sep2 != nullptr ? procurarAtras(p, sep2, ';') : nullptr;
+
+			ArmarioFichas::RegistoCliente r;
+			if (sep1 == nullptr || !LeituraTexto::lerInteiro(sep1 + 1, sep2, r.nif) || !LeituraTexto::lerInteiro(sep2 + 1, fimLinha, r.numConsultas)
+				|| r.numConsultas > ArmarioFichas::MAX_CONSULTAS) {
+				pedaco.invalidas++;
+			}
+			else {
+				r.nome = std::string_view(p, sep1 - p);
+				pedaco.registos.push_back(r);
+			}
+			p = proxima;
+		}
+	}
+}
+
+std::string ImportadorRegistos::Relatorio::obtemDesc() const {
+	return std::to_string(linhas) + " linhas / " + std::to_string(getAcrescentados()) + " acrescentados / "
+		+ std::to_string(duplicados) + " duplicados / " + std::to_string(invalidas) + " invalidas / "
+		+ std::to_string((long long)getLinhasPorSegundo()) + " linhas/s";
+}
+
+// ============================================================================
+// IMPORTAR
+// ============================================================================
+// Divisao em pedacos (ex: 3 threads):
+//
+//   ficheiro -> [..........\n.......|...\n..........|..\n.............]
+//                                   ^   ^          ^  ^
+//               divisao "ingenua" (tamanho/3)      |  avanca ate ao fim de linha
+//
+// Cada pedaco comeca no inicio de uma linha e acaba no fim de uma linha, por
+// isso nenhuma linha e lida por duas threads.
+// ============================================================================
+ImportadorRegistos::Relatorio ImportadorRegistos::importar(const std::string& caminho, ArmarioFichas& armario, int numThreads) {
+	auto inicio = std::chrono::steady_clock::now();
+
+	FicheiroMapeado ficheiro(caminho);
+	const char* dados = ficheiro.obtemDados();
+	const char* fimDados = dados + ficheiro.obtemTamanho();
+
+	if (numThreads <= 0) {
+		numThreads = (int)std::thread::hardware_concurrency();
+		if (numThreads <= 0) {
+			numThreads = 1;
+		}
+	}
+
+	// Pedacos de tamanho parecido, acertados ao fim de linha
+	std::vector<Pedaco> pedacos(numThreads);
+	const char* p = dados;
+	for (int t = 0; t < numThreads; t++) {
+		const char* fim = t == numThreads - 1 ? fimDados : dados + ficheiro.obtemTamanho() / numThreads * (t + 1);
+		if (fim < p) {
+			fim = p;
+		}
+		if (fim < fimDados) {
+			const char* nl = (const char*)memchr(fim, '\n', fimDados - fim);
+			fim = nl == nullptr ? fimDados : nl + 1;
+		}
+		pedacos[t].inicio = p;
+		pedacos[t].fim = fim;
+		p = fim;
+	}
+
+	// Ler os pedacos em paralelo (a thread atual le o ultimo)
+	std::vector<std::thread> threads;
+	for (int t = 0; t < numThreads - 1; t++) {
+		threads.emplace_back(lerPedaco, std::ref(pedacos[t]));
+	}
+	lerPedaco(pedacos[numThreads - 1]);
+	for (std::thread& th : threads) {
+		th.join();
+	}
+
+	// Juntar os registos (pela ordem do ficheiro) e acrescentar tudo num so passo
+	long long linhas = 0, invalidas = 0;
+	size_t total = 0;
+	for (const Pedaco& pd : pedacos) {
+		linhas += pd.linhas;
+		invalidas += pd.invalidas;
+		total += pd.registos.size();
+	}
+
+	std::vector<ArmarioFichas::RegistoCliente> registos;
+	registos.reserve(total);
+	for (Pedaco& pd : pedacos) {
+		registos.insert(registos.end(), pd.registos.begin(), pd.registos.end());
+		pd.registos = std::vector<ArmarioFichas::RegistoCliente>();	// libertar ja a memoria
+	}
+
+	long long duplicados = armario.acrescentarLote(registos);
+
+	double segundos = std::chrono::duration<double>(std::chrono::steady_clock::now() - inicio).count();
+	return Relatorio(linhas, invalidas, duplicados, segundos);
+}
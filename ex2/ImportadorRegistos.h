@@ -0,0 +1,56 @@
+#pragma once
+#include "ArmarioFichas.h"
+#include <string>
+
+// ============================================================================
+// IMPORTADOR DE REGISTOS
+// ============================================================================
+// Carrega um ArmarioFichas a partir de um ficheiro de texto com uma linha por
+// cliente no formato:
+//
+//   nome;NIF;consultas
+//   Joao Silva;123456789;4
+//   Maria Sousa;987654321;0
+//
+// Para ficheiros muito grandes (varios GB):
+//   1) O ficheiro e mapeado em memoria (sem copias para buffers intermedios)
+//   2) E dividido em tantos pedacos quantas as threads, sempre em fins de linha
+//   3) Cada thread le os seus pedacos com um parser de inteiros simples
+//      (sem std::stoi / istringstream, sem alocacoes por linha)
+//   4) Todos os registos sao acrescentados num so passo (acrescentarLote)
+//
+// Linhas mal formadas (ex: um cabecalho) sao contadas como invalidas, tal
+// como as que tem mais de ArmarioFichas::MAX_CONSULTAS consultas: o Cliente
+// so conta consultas uma a uma (novaConsulta()), por isso uma contagem
+// absurda (ex: 2000000000) prenderia a importacao durante minutos.
+// Erros ao abrir/mapear o ficheiro lancam std::runtime_error.
+// ============================================================================
+class ImportadorRegistos
+{
+public:
+	class Relatorio {
+		long long linhas;		// linhas nao vazias lidas
+		long long invalidas;	// linhas que nao estao no formato nome;NIF;consultas
+		long long duplicados;	// NIFs rejeitados por ja existirem
+		double segundos;		// tempo total (mapear + ler + acrescentar)
+
+	public:
+		//Construtor
+		Relatorio(long long linhasP, long long invalidasP, long long duplicadosP, double segundosP) :
+			linhas(linhasP), invalidas(invalidasP), duplicados(duplicadosP), segundos(segundosP) {}
+
+		//Getters
+		long long getLinhas() const { return linhas; }
+		long long getInvalidas() const { return invalidas; }
+		long long getDuplicados() const { return duplicados; }
+		long long getAcrescentados() const { return linhas - invalidas - duplicados; }
+		double getSegundos() const { return segundos; }
+		double getLinhasPorSegundo() const { return segundos > 0 ? linhas / segundos : 0; }
+
+		//Descricao (uma linha, para mostrar ao utilizador)
+		std::string obtemDesc() const;
+	};
+
+	//Importar o ficheiro 'caminho' para 'armario' (numThreads <= 0: uma por nucleo)
+	static Relatorio importar(const std::string& caminho, ArmarioFichas& armario, int numThreads = 0);
+};
@@ -0,0 +1,98 @@
+#include "IndiceConsultas.h"
+#include <iterator>
+
+// Retira o NIF na posicao 'indice' do balde (swap-and-pop, tal como no ArmarioFichas)
+// Se o balde ficar vazio, deixa de existir
+void IndiceConsultas::tirarDoBalde(std::map<int, std::vector<int>>::iterator balde, int indice) {
+	std::vector<int>& nifs = balde->second;
+
+	if (indice != (int)nifs.size() - 1) {
+		nifs[indice] = nifs.back();
+		posicoes[nifs[indice]].indice = indice;	// o NIF que veio do fim mudou de posicao
+	}
+	nifs.pop_back();
+
+	if (nifs.empty()) {
+		baldes.erase(balde);
+	}
+}
+
+void IndiceConsultas::acrescentar(int nif, int consultas) {
+	std::vector<int>& nifs = baldes[consultas];
+	posicoes[nif] = Posicao{ consultas, (int)nifs.size() };
+	nifs.push_back(nif);
+}
+
+// ============================================================================
+// INCREMENTAR
+// ============================================================================
+// Move o NIF do balde c para o balde c+1:
+//   { 2: [111, 222] , 3: [333] }   incrementar(111)
+//   { 2: [222] , 3: [333, 111] }
+//
+// O balde c+1, se existir, e o seguinte ao balde c no map, por isso e usado
+// como "dica" na insercao (emplace_hint e O(1) amortizado com a dica certa).
+// ============================================================================
+void IndiceConsultas::incrementar(int nif) {
+	auto p = posicoes.find(nif);
+	if (p == posicoes.end()) {
+		return;
+	}
+
+	int consultas = p->second.consultas;
+	int indice = p->second.indice;
+
+	auto balde = baldes.find(consultas);
+	auto seguinte = baldes.emplace_hint(std::next(balde), consultas + 1, std::vector<int>());
+
+	p->second = Posicao{ consultas + 1, (int)seguinte->second.size() };
+	seguinte->second.push_back(nif);
+
+	tirarDoBalde(balde, indice);
+}
+
+void IndiceConsultas::remover(int nif) {
+	auto p = posicoes.find(nif);
+	if (p == posicoes.end()) {
+		return;
+	}
+
+	Posicao pos = p->second;
+	posicoes.erase(p);
+
+	tirarDoBalde(baldes.find(pos.consultas), pos.indice);
+}
+
+void IndiceConsultas::limpar() {
+	baldes.clear();
+	posicoes.clear();
+}
+
+std::vector<int> IndiceConsultas::maisConsultas(int k) const {
+	std::vector<int> resultado;
+	if (k <= 0) {
+		return resultado;
+	}
+	resultado.reserve(k < (int)posicoes.size() ? k : posicoes.size());
+
+	// Do balde com mais consultas para o balde com menos
+	for (auto balde = baldes.rbegin(); balde != baldes.rend(); ++balde) {
+		for (int nif : balde->second) {
+			if ((int)resultado.size() == k) {
+				return resultado;
+			}
+			resultado.push_back(nif);
+		}
+	}
+	return resultado;
+}
+
+std::vector<int> IndiceConsultas::entre(int minimo, int maximo) const {
+	std::vector<int> resultado;
+
+	// lower_bound: primeiro balde com numConsultas >= minimo, O(log n)
+	for (auto balde = baldes.lower_bound(minimo); balde != baldes.end() && balde->first <= maximo; ++balde) {
+		resultado.insert(resultado.end(), balde->second.begin(), balde->second.end());
+	}
+	return resultado;
+}
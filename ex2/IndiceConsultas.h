@@ -0,0 +1,52 @@
+#pragma once
+#include <map>
+#include <unordered_map>
+#include <vector>
+
+// ============================================================================
+// INDICE POR NUMERO DE CONSULTAS
+// ============================================================================
+// Indice secundario do ArmarioFichas, ordenado por numero de consultas.
+// Os clientes estao agrupados em "baldes", um balde por cada numero de
+// consultas que existe no armario:
+//
+//   baldes -> { 0: [111, 444] , 3: [222] , 7: [333] }
+//
+// Como as consultas so aumentam de uma em uma, registar uma consulta e apenas
+// mover o NIF do balde c para o balde c+1 (que, se existir, e o seguinte).
+//
+// Consultas:
+//   - maisConsultas(k): percorre os baldes do maior para o menor, O(k)
+//   - entre(x, y): procura o primeiro balde >= x e percorre ate y, O(k + log n)
+// ============================================================================
+class IndiceConsultas
+{
+	struct Posicao {
+		int consultas;	// balde onde esta o NIF
+		int indice;		// posicao do NIF dentro do balde
+	};
+
+	std::map<int, std::vector<int>> baldes;		// numConsultas -> NIFs com esse numero de consultas
+	std::unordered_map<int, Posicao> posicoes;	// NIF -> onde esta nos baldes
+
+	void tirarDoBalde(std::map<int, std::vector<int>>::iterator balde, int indice);
+
+public:
+	//Novo cliente (por omissao sem consultas)
+	void acrescentar(int nif, int consultas = 0);
+
+	//Cliente 'nif' teve mais uma consulta
+	void incrementar(int nif);
+
+	//Cliente 'nif' foi apagado
+	void remover(int nif);
+
+	//Apagar todos os clientes
+	void limpar();
+
+	//NIFs dos k clientes com mais consultas (por ordem decrescente de consultas)
+	std::vector<int> maisConsultas(int k) const;
+
+	//NIFs dos clientes com numero de consultas em [minimo, maximo] (por ordem crescente de consultas)
+	std::vector<int> entre(int minimo, int maximo) const;
+};
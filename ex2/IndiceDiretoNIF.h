@@ -0,0 +1,200 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+// ============================================================================
+// INDICE DIRETO POR NIF (politica de indice do Armario, ver Armario.h)
+// ============================================================================
+// Um NIF tem 9 digitos e o ultimo e um digito de controlo (calculado a partir
+// dos outros 8). Por isso os NIFs validos sao so 10^8 e cada um e
+// identificado pelos 8 primeiros digitos:
+//
+//   NIF 123456789  ->  prefixo 12345678, digito 9
+//
+// Em vez de hash, uma "tabela de paginas" enderecada pelo prefixo:
+//
+//   prefixo = 12345678 -> pagina 12345678 >> 10 = 12056, ranhura 12345678 & 1023 = 334
+//
+//   paginas -> [ ][ ]...[pag 12056]...[ ]     (nullptr = pagina sem NIFs)
+//                            |
+//                            v
+//                 ranhuras [....][posicao+1 | digito 9][....]   (1024 ranhuras de 4 bytes)
+//
+// Procurar = 2 acessos a memoria (ponteiro da pagina + ranhura), sem hash
+// nem comparacoes em cadeia. As paginas so sao criadas quando recebem o
+// primeiro NIF e sao apagadas quando ficam vazias.
+//
+// NIFs fora de [0, 10^9) e NIFs com o mesmo prefixo que outro ja guardado
+// (so acontece com NIFs invalidos) vao para uma tabela de hash a parte, que
+// normalmente fica vazia e nem e consultada.
+//
+// Medido com ex2_bench --memoria (bytes por NIF / ns por procura):
+//
+//   clientes   NIFs seguidos            NIFs espalhados
+//              direto      hash         direto         hash
+//   10^4       83 / 5      24 / 26      3249 / 16      24 / 5
+//   10^6       4.8 / 24    28 / 64      361 / 54       28 / 84
+//   10^7       4.1 / 35    26 / 145     36 / 55        26 / 74
+//
+// Ou seja: com NIFs densos (atribuidos em sequencia, ou milhoes de clientes)
+// gasta ~6x menos memoria do que uma std::unordered_map e procura mais
+// depressa; com poucos clientes espalhados cada NIF ocupa quase uma pagina
+// (4 KB) e a procura linear ou a tabela de hash sao melhores.
+// ============================================================================
+template <typename Chave>
+class IndiceDiretoNIF
+{
+	static_assert(std::is_integral_v<Chave>, "IndiceDiretoNIF: a chave tem de ser um NIF inteiro");
+
+	static const int BITS_PAGINA = 10;
+	static const int TAMANHO_PAGINA = 1 << BITS_PAGINA;
+	static const int NUM_PREFIXOS = 100000000;	// 8 digitos
+	static const int NUM_PAGINAS = (NUM_PREFIXOS + TAMANHO_PAGINA - 1) / TAMANHO_PAGINA;
+
+	// Ranhura: 0 = vazia, senao ((posicao + 1) << 4) | digito de controlo
+	struct Pagina {
+		uint32_t ranhuras[TAMANHO_PAGINA];
+		int ocupadas;
+	};
+
+	std::vector<std::unique_ptr<Pagina>> paginas;	// vazio ate ao primeiro NIF, depois NUM_PAGINAS entradas
+	int numPaginas;									// paginas criadas
+	std::unordered_map<Chave, int> extra;			// NIFs fora do intervalo ou com prefixo repetido
+
+	static bool noIntervalo(Chave c) { return c >= 0 && c < (Chave)NUM_PREFIXOS * 10; }
+
+	// Ranhura do NIF c, ou nullptr se a pagina nao existir
+	uint32_t* ranhuraDe(Chave c) const {
+		if (paginas.empty()) {
+			return nullptr;
+		}
+		int prefixo = (int)(c / 10);
+		Pagina* p = paginas[prefixo >> BITS_PAGINA].get();
+		return p != nullptr ? &p->ranhuras[prefixo & (TAMANHO_PAGINA - 1)] : nullptr;
+	}
+
+	static bool eDoNIF(uint32_t r, Chave c) { return r != 0 && (r & 15) == (uint32_t)(c % 10); }
+
+	void inserir(Chave c, int pos) {
+		if (noIntervalo(c)) {
+			if (paginas.empty()) {
+				paginas.resize(NUM_PAGINAS);
+			}
+			int prefixo = (int)(c / 10);
+			std::unique_ptr<Pagina>& p = paginas[prefixo >> BITS_PAGINA];
+			if (p == nullptr) {
+				p.reset(new Pagina());	// () -> ranhuras a zero
+				numPaginas++;
+			}
+			uint32_t& r = p->ranhuras[prefixo & (TAMANHO_PAGINA - 1)];
+			if (r == 0) {
+				r = ((uint32_t)(pos + 1) << 4) | (uint32_t)(c % 10);
+				p->ocupadas++;
+				return;
+			}
+		}
+		extra.emplace(c, pos);
+	}
+
+	void apagar(Chave c) {
+		if (noIntervalo(c)) {
+			uint32_t* r = ranhuraDe(c);
+			if (r != nullptr && eDoNIF(*r, c)) {
+				*r = 0;
+				int prefixo = (int)(c / 10);
+				std::unique_ptr<Pagina>& p = paginas[prefixo >> BITS_PAGINA];
+				if (--p->ocupadas == 0) {
+					p.reset();
+					numPaginas--;
+				}
+				return;
+			}
+		}
+		extra.erase(c);
+	}
+
+	void mudar(Chave c, int pos) {
+		if (noIntervalo(c)) {
+			uint32_t* r = ranhuraDe(c);
+			if (r != nullptr && eDoNIF(*r, c)) {
+				*r = ((uint32_t)(pos + 1) << 4) | (*r & 15);
+				return;
+			}
+		}
+		extra[c] = pos;
+	}
+
+public:
+	//Construtor
+	IndiceDiretoNIF() : numPaginas(0) {}
+
+	//Construtor por Copia (copia so as paginas que existem)
+	IndiceDiretoNIF(const IndiceDiretoNIF& outro) : numPaginas(outro.numPaginas), extra(outro.extra) {
+		if (!outro.paginas.empty()) {
+			paginas.resize(NUM_PAGINAS);
+			for (int i = 0; i < NUM_PAGINAS; i++) {
+				if (outro.paginas[i] != nullptr) {
+					paginas[i].reset(new Pagina(*outro.paginas[i]));
+				}
+			}
+		}
+	}
+
+	//Operador de Atribuicao
+	IndiceDiretoNIF& operator=(const IndiceDiretoNIF& outro) {
+		if (this != &outro) {
+			IndiceDiretoNIF copia(outro);
+			paginas.swap(copia.paginas);
+			extra.swap(copia.extra);
+			numPaginas = copia.numPaginas;
+		}
+		return *this;
+	}
+
+	int procurar(const Chave& c) const {
+		if (noIntervalo(c)) {
+			const uint32_t* r = ranhuraDe(c);
+			if (r != nullptr && eDoNIF(*r, c)) {
+				return (int)(*r >> 4) - 1;
+			}
+		}
+		if (extra.empty()) {
+			return -1;
+		}
+		auto e = extra.find(c);
+		return e != extra.end() ? e->second : -1;
+	}
+
+	void acrescentado(const Chave& c, int pos) { inserir(c, pos); }
+
+	void acrescentadosVarios(std::span<const Chave> cs, int posInicial) {
+		for (int k = 0; k < (int)cs.size(); k++) {
+			inserir(cs[k], posInicial + k);
+		}
+	}
+
+	void removido(const Chave& c, int pos, const Chave& ultima, int posUltima) {
+		apagar(c);
+		if (pos != posUltima) {
+			mudar(ultima, pos);
+		}
+	}
+
+	void limpar() {
+		paginas.clear();
+		paginas.shrink_to_fit();
+		numPaginas = 0;
+		extra.clear();
+	}
+
+	//Memoria ocupada pelo indice (bytes; a tabela 'extra' e estimada)
+	size_t getBytes() const {
+		size_t bytes = paginas.capacity() * sizeof(std::unique_ptr<Pagina>) + (size_t)numPaginas * sizeof(Pagina);
+		bytes += extra.bucket_count() * sizeof(void*) + extra.size() * (sizeof(std::pair<const Chave, int>) + 2 * sizeof(void*));
+		return bytes;
+	}
+};
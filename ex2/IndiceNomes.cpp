@@ -0,0 +1,59 @@
+#include "IndiceNomes.h"
+#include <algorithm>
+#include <iterator>
+
+void IndiceNomes::acrescentar(const std::string& nome, int nif) {
+	std::pair<std::string, int> entrada(nome, nif);
+
+	// Inserir na posicao que mantem o array ordenado
+	auto pos = std::lower_bound(nomes.begin(), nomes.end(), entrada);
+	nomes.insert(pos, std::move(entrada));
+}
+
+// Inserir um a um custaria O(n) por cliente (deslocar o array de cada vez).
+// Aqui ordenam-se so os novos, acrescentam-se no fim e junta-se tudo com um
+// merge: O(n + m log m) para m clientes novos.
+void IndiceNomes::acrescentarVarios(std::vector<std::pair<std::string, int>> novos) {
+	std::sort(novos.begin(), novos.end());
+
+	size_t meio = nomes.size();
+	nomes.insert(nomes.end(), std::make_move_iterator(novos.begin()), std::make_move_iterator(novos.end()));
+	std::inplace_merge(nomes.begin(), nomes.begin() + meio, nomes.end());
+}
+
+void IndiceNomes::remover(const std::string& nome, int nif) {
+	auto pos = std::lower_bound(nomes.begin(), nomes.end(), std::make_pair(nome, nif));
+	if (pos != nomes.end() && pos->second == nif && pos->first == nome) {
+		nomes.erase(pos);
+	}
+}
+
+void IndiceNomes::limpar() {
+	nomes.clear();
+}
+
+// ============================================================================
+// PROCURAR
+// ============================================================================
+// Exemplo: procurar("Jo")
+//
+//   nomes -> [Ana][Joao][Joaquim][Maria]
+//                  ^              ^
+//                  |              primeiro que NAO comeca por "Jo": para
+//                  lower_bound("Jo"): primeiro nome >= "Jo"
+//
+//   Resultado: [111, 333]
+// ============================================================================
+std::vector<int> IndiceNomes::procurar(const std::string& prefixo) const {
+	std::vector<int> resultado;
+
+	auto pos = std::lower_bound(nomes.begin(), nomes.end(), prefixo,
+		[](const std::pair<std::string, int>& entrada, const std::string& p) {
+			return entrada.first < p;
+		});
+
+	for (; pos != nomes.end() && pos->first.compare(0, prefixo.size(), prefixo) == 0; ++pos) {
+		resultado.push_back(pos->second);
+	}
+	return resultado;
+}
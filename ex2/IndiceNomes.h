@@ -0,0 +1,41 @@
+#pragma once
+#include <string>
+#include <utility>
+#include <vector>
+
+// ============================================================================
+// INDICE POR NOME
+// ============================================================================
+// Indice secundario do ArmarioFichas para procurar clientes pelo inicio do
+// nome. Guarda os pares (nome, NIF) num array ORDENADO por nome:
+//
+//   nomes -> [("Ana", 444)] [("Joao", 111)] [("Joaquim", 333)] [("Maria", 222)]
+//
+// Todos os nomes que comecam por um prefixo estao seguidos no array, por isso
+// basta uma pesquisa binaria para encontrar o primeiro e depois avancar
+// enquanto o prefixo coincidir: O(log n + k), com k = numero de resultados.
+//
+// Acrescentar e apagar deslocam os elementos seguintes (O(n)), tal como o
+// proprio ArmarioFichas ja faz ao redimensionar o array 'clientes'.
+// A comparacao e feita byte a byte (distingue maiusculas de minusculas).
+// ============================================================================
+class IndiceNomes
+{
+	std::vector<std::pair<std::string, int>> nomes;	// (nome, NIF) ordenados por nome e depois por NIF
+
+public:
+	//Novo cliente
+	void acrescentar(const std::string& nome, int nif);
+
+	//Varios clientes novos de uma so vez (ordena so os novos e junta-os aos existentes)
+	void acrescentarVarios(std::vector<std::pair<std::string, int>> novos);
+
+	//Cliente apagado
+	void remover(const std::string& nome, int nif);
+
+	//Apagar todos os clientes
+	void limpar();
+
+	//NIFs dos clientes cujo nome comeca por 'prefixo' (por ordem alfabetica do nome)
+	std::vector<int> procurar(const std::string& prefixo) const;
+};
@@ -0,0 +1,38 @@
+#pragma once
+
+// ============================================================================
+// LEITURA DE TEXTO (partilhada pelo ImportadorRegistos e o ServidorComandos)
+// ============================================================================
+// Parsers pequenos para texto que chega de fora (ficheiros, sockets), sobre
+// intervalos [inicio, fim) sem terminador: sem std::stoi / istringstream,
+// sem locale, sem excecoes e sem std::string.
+//
+// Exemplo de uso:
+//   const char* s = "123;4";
+//   int nif;
+//   LeituraTexto::lerInteiro(s, s + 3, nif);     // true, nif = 123
+//   LeituraTexto::lerInteiro(s, s + 4, nif);     // false (';' nao e digito)
+// ============================================================================
+class LeituraTexto
+{
+public:
+	//Ler um inteiro nao negativo em [inicio, fim): so digitos, sem sinal nem espacos, ate 2^31 - 1
+	static bool lerInteiro(const char* inicio, const char* fim, int& valor) {
+		if (inicio == fim || fim - inicio > 10) {
+			return false;
+		}
+		long long v = 0;
+		for (const char* p = inicio; p < fim; p++) {
+			unsigned d = (unsigned)(*p - '0');
+			if (d > 9) {
+				return false;
+			}
+			v = v * 10 + d;
+		}
+		if (v > 0x7fffffff) {
+			return false;
+		}
+		valor = (int)v;
+		return true;
+	}
+};
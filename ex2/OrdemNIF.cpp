@@ -0,0 +1,188 @@
+#include "OrdemNIF.h"
+#include <algorithm>
+#include <bit>
+#include <utility>
+
+void OrdemNIF::ativar(bool ativaP) {
+	limpar();
+	ativa = ativaP;
+}
+
+void OrdemNIF::acrescentar(const Cliente* cliente) {
+	novos[cliente->obtemNIF()] = cliente;
+	if (novos.size() + apagados.size() > std::max<size_t>(MIN_PENDENTES, nifs.size() / 8)) {
+		consolidar();
+	}
+}
+
+void OrdemNIF::acrescentarVarios(std::span<Cliente* const> novosClientes) {
+	novos.reserve(novos.size() + novosClientes.size());
+	for (const Cliente* c : novosClientes) {
+		novos[c->obtemNIF()] = c;
+	}
+	consolidar();
+}
+
+void OrdemNIF::remover(int nif) {
+	// Um NIF que ainda estava pendente nunca chegou a 'nifs'
+	if (novos.erase(nif) == 0) {
+		apagados.push_back(nif);
+		if (novos.size() + apagados.size() > std::max<size_t>(MIN_PENDENTES, nifs.size() / 8)) {
+			consolidar();
+		}
+	}
+}
+
+void OrdemNIF::limpar() {
+	nifs.clear();
+	clientes.clear();
+	topo.clear();
+	blocoDe.clear();
+	novos.clear();
+	apagados.clear();
+}
+
+// ============================================================================
+// CONSOLIDAR
+// ============================================================================
+// Aplica os pendentes de uma so vez:
+//   1) Tira os apagados (ordenados) numa passagem por 'nifs'
+//   2) Ordena os novos e junta-os com um merge feito do fim para o inicio,
+//      no proprio array (sem array auxiliar)
+//   3) Reconstroi o 'topo'
+//
+//   nifs   -> [101][110][190]        apagados -> [110]
+//   novos  -> {150, 105}
+//
+//   1) nifs -> [101][190]
+//   2) nifs -> [101][105][150][190]
+// ============================================================================
+void OrdemNIF::consolidar() const {
+	if (novos.empty() && apagados.empty()) {
+		return;
+	}
+
+	// 1) Apagados
+	std::sort(apagados.begin(), apagados.end());
+	size_t escritos = 0;
+	size_t a = 0;
+	for (size_t i = 0; i < nifs.size(); i++) {
+		while (a < apagados.size() && apagados[a] < nifs[i]) {
+			a++;
+		}
+		if (a < apagados.size() && apagados[a] == nifs[i]) {
+			continue;
+		}
+		nifs[escritos] = nifs[i];
+		clientes[escritos] = clientes[i];
+		escritos++;
+	}
+	nifs.resize(escritos);
+	clientes.resize(escritos);
+
+	// 2) Novos
+	std::vector<std::pair<int, const Cliente*>> ordenados(novos.begin(), novos.end());
+	std::sort(ordenados.begin(), ordenados.end(),
+		[](const std::pair<int, const Cliente*>& x, const std::pair<int, const Cliente*>& y) { return x.first < y.first; });
+
+	size_t i = nifs.size();
+	size_t j = ordenados.size();
+	size_t k = i + j;
+	nifs.resize(k);
+	clientes.resize(k);
+	while (j > 0) {
+		k--;
+		if (i > 0 && nifs[i - 1] > ordenados[j - 1].first) {
+			i--;
+			nifs[k] = nifs[i];
+			clientes[k] = clientes[i];
+		}
+		else {
+			j--;
+			nifs[k] = ordenados[j].first;
+			clientes[k] = ordenados[j].second;
+		}
+	}
+
+	novos.clear();
+	apagados.clear();
+
+	// 3) Topo
+	construirTopo();
+}
+
+// O primeiro NIF de cada bloco, por ordem, distribuido em Eytzinger: uma
+// visita "em ordem" (esquerda, raiz, direita) da arvore 1..numBlocos recebe
+// os blocos por ordem crescente.
+void OrdemNIF::construirTopo() const {
+	int numBlocos = (int)((nifs.size() + NIFS_POR_BLOCO - 1) / NIFS_POR_BLOCO);
+	topo.assign(numBlocos + 1, 0);
+	blocoDe.assign(numBlocos + 1, 0);
+
+	int proximo = 0;
+	auto preencher = [&](auto& preencherP, int k) -> void {
+		if (k > numBlocos) {
+			return;
+		}
+		preencherP(preencherP, 2 * k);
+		topo[k] = nifs[(size_t)proximo * NIFS_POR_BLOCO];
+		blocoDe[k] = proximo++;
+		preencherP(preencherP, 2 * k + 1);
+	};
+	preencher(preencher, 1);
+}
+
+// ============================================================================
+// LIMITE INFERIOR
+// ============================================================================
+// 1) Descer no 'topo' sem ifs: em cada no vai-se para a direita se o NIF do
+//    no for < nif. No fim, tirar os "passos para a direita" finais de k da
+//    o primeiro bloco cujo primeiro NIF e >= nif (k == 0: nenhum).
+// 2) A resposta esta no bloco anterior a esse: contar quantos NIFs desse
+//    bloco sao < nif (16 comparacoes independentes, vetorizaveis).
+// ============================================================================
+int OrdemNIF::limiteInferior(int nif) const {
+	int numBlocos = (int)topo.size() - 1;
+	if (numBlocos <= 0) {
+		return 0;
+	}
+
+	int k = 1;
+	while (k <= numBlocos) {
+		k = 2 * k + (topo[k] < nif);
+	}
+	k >>= std::countr_one((unsigned)k) + 1;
+	int bloco = k == 0 ? numBlocos : blocoDe[k];
+
+	if (bloco == 0) {
+		return 0;
+	}
+	int inicio = (bloco - 1) * NIFS_POR_BLOCO;
+	int fim = std::min(inicio + NIFS_POR_BLOCO, (int)nifs.size());
+	int menores = 0;
+	for (int i = inicio; i < fim; i++) {
+		menores += nifs[i] < nif;
+	}
+	return inicio + menores;
+}
+
+std::vector<int> OrdemNIF::entre(int minimo, int maximo) const {
+	consolidar();
+
+	std::vector<int> resultado;
+	for (size_t i = limiteInferior(minimo); i < nifs.size() && nifs[i] <= maximo; i++) {
+		resultado.push_back(nifs[i]);
+	}
+	return resultado;
+}
+
+std::string OrdemNIF::listagem() const {
+	consolidar();
+
+	std::string texto;
+	for (const Cliente* c : clientes) {
+		texto += c->obtemDesc();
+		texto += '\n';
+	}
+	return texto;
+}
@@ -0,0 +1,80 @@
+#pragma once
+#include "Cliente.h"
+#include <span>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// ============================================================================
+// ORDEM POR NIF (modo opcional do ArmarioFichas)
+// ============================================================================
+// Mantem os clientes ordenados por NIF, para listagens por NIF e pedidos do
+// tipo "todos os NIFs entre a e b", sem mexer na ordem do array 'clientes'
+// (que o swap-and-pop baralha).
+//
+// Disposicao (parecida com uma B-tree de 2 niveis):
+//
+//   nifs     -> [101][105][110]...[190] [201][207]...[260] [301]...   ordenados, contiguos
+//               |------ bloco 0 -------| |----- bloco 1 ----| ...      16 NIFs por bloco
+//
+//   topo     -> primeiro NIF de cada bloco, em ordem de Eytzinger
+//               (arvore binaria guardada por niveis: filhos de k em 2k e 2k+1)
+//
+//               k=1: 301
+//              /        \          topo -> [ ][301][201][401]
+//      k=2: 201          k=3: 401
+//
+// Procurar x = descer no 'topo' sem ifs (k = 2k + (topo[k] < x)) ate saber
+// o bloco, e depois contar os NIFs < x dentro desse bloco (16 comparacoes
+// seguidas, sem saltos). O 'topo' tem 1/16 dos NIFs, por isso fica na cache.
+// Uma listagem ou um intervalo [a, b] e so percorrer 'nifs' a partir dai.
+//
+// Inserir no meio de um array ordenado custaria O(n) por NIF. Em vez disso,
+// os NIFs novos e apagados ficam pendentes e sao aplicados todos de uma vez
+// (ordenar os novos + merge, O(n + k log k)) antes da proxima consulta, ou
+// quando ja ha demasiados pendentes.
+// ============================================================================
+class OrdemNIF
+{
+	static const int NIFS_POR_BLOCO = 16;	// 64 bytes de NIFs: uma linha de cache
+	static const int MIN_PENDENTES = 4096;	// aplicar quando ha max(4096, n/8) pendentes
+
+	bool ativa;
+
+	// Consolidado (so muda em consolidar)
+	mutable std::vector<int> nifs;						// ordenados
+	mutable std::vector<const Cliente*> clientes;		// clientes[i] tem o NIF nifs[i]
+	mutable std::vector<int> topo;						// primeiros NIFs dos blocos, Eytzinger (1..numBlocos)
+	mutable std::vector<int> blocoDe;					// blocoDe[k] = numero do bloco de topo[k]
+
+	// Pendentes
+	mutable std::unordered_map<int, const Cliente*> novos;	// acrescentados desde a ultima consolidacao
+	mutable std::vector<int> apagados;						// apagados que ja estavam em 'nifs'
+
+	void consolidar() const;
+	void construirTopo() const;
+	int limiteInferior(int nif) const;	// primeira posicao em 'nifs' com NIF >= nif
+
+public:
+	//Construtor (desativada)
+	OrdemNIF() : ativa(false) {}
+
+	//Ativar/desativar (desativar apaga tudo)
+	void ativar(bool ativaP);
+	bool estaAtiva() const { return ativa; }
+
+	//Acompanhar as alteracoes do armario
+	void acrescentar(const Cliente* cliente);
+	void acrescentarVarios(std::span<Cliente* const> novosClientes);	// consolida logo
+	void remover(int nif);
+	void limpar();
+
+	//NIFs entre minimo e maximo (inclusive), por ordem crescente
+	std::vector<int> entre(int minimo, int maximo) const;
+
+	//Listagem (uma linha por cliente, como ArmarioFichas::listagem) por ordem de NIF
+	std::string listagem() const;
+
+	//Os clientes por ordem de NIF (valido ate a proxima alteracao)
+	std::span<const Cliente* const> porOrdem() const { consolidar(); return clientes; }
+};
@@ -0,0 +1,158 @@
+#include "OrdenacaoNomes.h"
+#include <algorithm>
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <xmmintrin.h>
+#define PREFETCH(p) _mm_prefetch((const char*)(p), _MM_HINT_T0)
+#elif defined(__GNUC__)
+#define PREFETCH(p) __builtin_prefetch(p)
+#else
+#define PREFETCH(p) ((void)0)
+#endif
+
+OrdenacaoNomes::OrdenacaoNomes(std::span<const std::string_view> nomesP, std::span<const int> desempateP)
+	: nomes(nomesP), desempate(desempateP) {
+}
+
+std::vector<int> OrdenacaoNomes::ordenar() {
+	int n = (int)nomes.size();
+	ordem.resize(n);
+	for (int i = 0; i < n; i++) {
+		ordem[i] = i;
+	}
+	chaves.resize(n);
+	ordemAux.resize(n);
+	chavesAux.resize(n);
+
+	carregarChaves(0, n, 0);
+	ordenarBaldes(0, n, 0, 0);
+
+	chaves.clear();
+	ordemAux.clear();
+	chavesAux.clear();
+	return std::move(ordem);
+}
+
+// Os 8 caracteres de cada nome a partir de 'profundidade', o primeiro nos
+// bits mais altos (depois do fim do nome ficam zeros).
+// Os nomes estao espalhados pela memoria: pede-se a cache com antecedencia a
+// string_view de ordem[i + 32] e os caracteres de ordem[i + 16], para varios
+// acessos estarem a caminho ao mesmo tempo (metade do tempo com 10^6 nomes).
+void OrdenacaoNomes::carregarChaves(int inicio, int fim, size_t profundidade) {
+	for (int i = inicio; i < fim; i++) {
+		if (i + 32 < fim) {
+			PREFETCH(&nomes[ordem[i + 32]]);
+		}
+		if (i + 16 < fim) {
+			PREFETCH(nomes[ordem[i + 16]].data() + profundidade);
+		}
+		std::string_view nome = nomes[ordem[i]];
+		uint64_t chave = 0;
+		for (size_t k = 0; k < 8; k++) {
+			size_t p = profundidade + k;
+			chave = (chave << 8) | (p < nome.size() ? (unsigned char)nome[p] : 0);
+		}
+		chaves[i] = chave;
+	}
+}
+
+// ============================================================================
+// ORDENAR POR BALDES (um nivel = um caracter da chave)
+// ============================================================================
+// ordem[inicio, fim) ja tem os nomes iguais ate 'profundidade' + 'caracter'.
+//   1) Contar quantos nomes ha em cada balde (caracter 'caracter' da chave)
+//   2) Distribuir posicoes e chaves pelos baldes (para os auxiliares e de volta)
+//   3) Balde 0 (nomes que acabaram): ordenar comparando (so falta o desempate)
+//      Restantes baldes: ordenar pelo caracter seguinte
+//
+// Se todos caem no mesmo balde (prefixo comum, ex: "Maria ..."), passa-se
+// logo ao caracter seguinte sem distribuir. Depois do 8o caracter da chave,
+// carregam-se as chaves seguintes so para este balde.
+// ============================================================================
+void OrdenacaoNomes::ordenarBaldes(int inicio, int fim, size_t profundidade, int caracter) {
+	while (true) {
+		if (caracter == 8) {
+			profundidade += 8;
+			caracter = 0;
+			carregarChaves(inicio, fim, profundidade);
+		}
+		if (fim - inicio < MIN_RADIX) {
+			ordenarInsercao(inicio, fim, profundidade);
+			return;
+		}
+
+		// 1) Contar
+		int deslocamento = 56 - 8 * caracter;
+		int contagem[256] = {};
+		for (int i = inicio; i < fim; i++) {
+			contagem[(chaves[i] >> deslocamento) & 0xFF]++;
+		}
+
+		int primeiro = (int)((chaves[inicio] >> deslocamento) & 0xFF);
+		if (contagem[primeiro] == fim - inicio) {
+			if (primeiro == 0) {
+				ordenarComparando(inicio, fim, profundidade);
+				return;
+			}
+			caracter++;
+			continue;
+		}
+
+		// 2) Distribuir
+		int posicao[256];
+		int soma = inicio;
+		for (int b = 0; b < 256; b++) {
+			posicao[b] = soma;
+			soma += contagem[b];
+		}
+		for (int i = inicio; i < fim; i++) {
+			int destino = posicao[(chaves[i] >> deslocamento) & 0xFF]++;
+			ordemAux[destino] = ordem[i];
+			chavesAux[destino] = chaves[i];
+		}
+		std::copy(ordemAux.begin() + inicio, ordemAux.begin() + fim, ordem.begin() + inicio);
+		std::copy(chavesAux.begin() + inicio, chavesAux.begin() + fim, chaves.begin() + inicio);
+
+		// 3) Cada balde pelo caracter seguinte
+		int comeco = inicio;
+		if (contagem[0] > 1) {
+			ordenarComparando(comeco, comeco + contagem[0], profundidade);
+		}
+		comeco += contagem[0];
+		for (int b = 1; b < 256; b++) {
+			if (contagem[b] > 1) {
+				ordenarBaldes(comeco, comeco + contagem[b], profundidade, caracter + 1);
+			}
+			comeco += contagem[b];
+		}
+		return;
+	}
+}
+
+// Nomes a partir de 'profundidade' (os caracteres antes ja sao iguais), e
+// nomes iguais por desempate. Um caracter '\0' no meio de um nome tambem cai
+// no balde 0, por isso aqui compara-se o nome todo e nao so o desempate.
+bool OrdenacaoNomes::menor(int a, int b, size_t profundidade) const {
+	int cmp = nomes[a].substr(profundidade).compare(nomes[b].substr(profundidade));
+	return cmp != 0 ? cmp < 0 : desempate[a] < desempate[b];
+}
+
+// Insercao pelas chaves, e pelos nomes so quando as chaves sao iguais
+void OrdenacaoNomes::ordenarInsercao(int inicio, int fim, size_t profundidade) {
+	for (int i = inicio + 1; i < fim; i++) {
+		int atual = ordem[i];
+		uint64_t chave = chaves[i];
+		int j = i;
+		while (j > inicio && (chave < chaves[j - 1] || (chave == chaves[j - 1] && menor(atual, ordem[j - 1], profundidade)))) {
+			ordem[j] = ordem[j - 1];
+			chaves[j] = chaves[j - 1];
+			j--;
+		}
+		ordem[j] = atual;
+		chaves[j] = chave;
+	}
+}
+
+void OrdenacaoNomes::ordenarComparando(int inicio, int fim, size_t profundidade) {
+	std::sort(ordem.begin() + inicio, ordem.begin() + fim, [&](int a, int b) { return menor(a, b, profundidade); });
+}
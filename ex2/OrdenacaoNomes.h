@@ -0,0 +1,64 @@
+#pragma once
+#include <cstdint>
+#include <span>
+#include <string_view>
+#include <vector>
+
+// ============================================================================
+// ORDENACAO POR NOME (radix sort MSD)
+// ============================================================================
+// Ordena uma PERMUTACAO (posicoes 0..n-1) pelos nomes, sem mexer nos nomes
+// nem nos objetos a que pertencem: so se trocam inteiros.
+//
+// Radix sort MSD ("most significant digit"): distribui as posicoes por 256
+// baldes pelo 1o caracter do nome (balde 0 = nome ja acabou), depois cada
+// balde pelo 2o caracter, e assim por diante:
+//
+//   nomes -> [0 "Rui"] [1 "Ana"] [2 "Rita"] [3 "Ana"]
+//
+//   caracter 0:  'A' -> {1, 3}          'R' -> {0, 2}
+//   caracter 1:  'n' -> {1, 3}          'i' -> {2}   'u' -> {0}
+//   ...
+//   nomes iguais ("Ana", "Ana") ficam no balde 0 e sao desempatados (NIF)
+//
+//   ordem -> [1][3][2][0]
+//
+// Para nao ir a memoria de cada nome em todos os niveis, guarda-se ao lado
+// de cada posicao uma "chave" com os 8 caracteres seguintes do nome, num
+// inteiro de 64 bits (o 1o caracter nos bits mais altos, e 0 depois do fim):
+//
+//   "Maria Silva" (profundidade 0) -> chave 'M''a''r''i''a'' ''S''i'
+//
+// Comparar chaves como inteiros da a mesma ordem que comparar esses 8
+// caracteres, por isso os 8 niveis seguintes so leem as chaves, que andam
+// junto com as posicoes (sequencialmente). Os nomes so voltam a ser lidos de
+// 8 em 8 caracteres, e so nos baldes que ainda tem nomes por separar.
+// Baldes pequenos (< 32) sao acabados por insercao, que ai e mais rapida.
+//
+// A ordem e a mesma que a de std::string::operator< (caracteres comparados
+// como unsigned char), ou seja a mesma do IndiceNomes.
+// ============================================================================
+class OrdenacaoNomes
+{
+	static const int MIN_RADIX = 32;	// baldes mais pequenos vao por insercao
+
+	std::span<const std::string_view> nomes;
+	std::span<const int> desempate;
+	std::vector<int> ordem;			// a permutacao a ordenar
+	std::vector<uint64_t> chaves;	// chaves[i] = 8 caracteres do nome de ordem[i], a partir da profundidade atual
+	std::vector<int> ordemAux;		// destino da distribuicao por baldes
+	std::vector<uint64_t> chavesAux;
+
+	void carregarChaves(int inicio, int fim, size_t profundidade);
+	void ordenarBaldes(int inicio, int fim, size_t profundidade, int caracter);
+	void ordenarInsercao(int inicio, int fim, size_t profundidade);
+	void ordenarComparando(int inicio, int fim, size_t profundidade);
+	bool menor(int a, int b, size_t profundidade) const;
+
+public:
+	//Construtor (nomes[i] e desempate[i] sao do registo i)
+	OrdenacaoNomes(std::span<const std::string_view> nomesP, std::span<const int> desempateP);
+
+	//Posicoes dos registos por ordem de nome (nomes iguais por ordem de desempate)
+	std::vector<int> ordenar();
+};
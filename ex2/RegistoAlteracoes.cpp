@@ -0,0 +1,197 @@
+#include "RegistoAlteracoes.h"
+
+namespace {
+
+	const unsigned char VERSAO_FORMATO = 1;
+
+	// Inteiro sem sinal em "varint": 7 bits por byte, o bit mais alto indica
+	// que ha mais bytes. Numeros pequenos (deltas, contagens) ocupam 1 byte.
+	void escreverVarint(std::string& saida, unsigned long long v) {
+		while (v >= 0x80) {
+			saida.push_back((char)(v | 0x80));
+			v >>= 7;
+		}
+		saida.push_back((char)v);
+	}
+
+	bool lerVarint(std::string_view dados, size_t& pos, unsigned long long& v) {
+		v = 0;
+		for (int deslocamento = 0; deslocamento < 64; deslocamento += 7) {
+			if (pos >= dados.size()) {
+				return false;
+			}
+			unsigned char b = (unsigned char)dados[pos++];
+			v |= (unsigned long long)(b & 0x7f) << deslocamento;
+			if ((b & 0x80) == 0) {
+				return true;
+			}
+		}
+		return false;
+	}
+
+	// O NIF vai como (unsigned) do int, por isso qualquer valor de 32 bits e
+	// valido (os acima de INT_MAX sao NIFs negativos); mais do que isso seria
+	// cortado ao voltar a int
+	bool lerNIF(std::string_view dados, size_t& pos, int& nif) {
+		unsigned long long v;
+		if (!lerVarint(dados, pos, v) || v > 0xffffffffULL) {
+			return false;
+		}
+		nif = (int)(unsigned int)v;
+		return true;
+	}
+
+	// Consultas (iniciais ou delta): nunca negativas, ate MAX_CONSULTAS
+	bool lerContagem(std::string_view dados, size_t& pos, int& valor) {
+		unsigned long long v;
+		if (!lerVarint(dados, pos, v) || v > (unsigned long long)RegistoAlteracoes::MAX_CONSULTAS) {
+			return false;
+		}
+		valor = (int)v;
+		return true;
+	}
+}
+
+RegistoAlteracoes::RegistoAlteracoes(unsigned long long sequenciaInicial) : sequencia(sequenciaInicial), ativo(false) {}
+
+void RegistoAlteracoes::ativar(bool ativoP) {
+	ativo = ativoP;
+	if (!ativo) {
+		alteracoes.clear();
+		alteracoes.shrink_to_fit();
+	}
+}
+
+void RegistoAlteracoes::guardar(Tipo tipo, int nif, int valor, std::string_view nome) {
+	++sequencia;
+	if (!ativo) {
+		return;
+	}
+	alteracoes.push_back(Alteracao{ sequencia, tipo, nif, valor, std::string(nome) });
+	if (alteracoes.size() > MAX_ALTERACOES) {
+		alteracoes.pop_front();
+	}
+}
+
+void RegistoAlteracoes::recomecar(unsigned long long sequenciaInicial) {
+	alteracoes.clear();
+	sequencia = sequenciaInicial;
+}
+
+// ============================================================================
+// CODIFICAR DESDE
+// ============================================================================
+// Formato (todos os numeros em varint):
+//
+//   [versao][primeira sequencia][numero de entradas] [entrada] [entrada] ...
+//
+//   entrada ACRESCENTAR: [1][nif][tamanho do nome][nome...][consultas]
+//   entrada APAGAR:      [2][nif]
+//   entrada CONSULTAS:   [3][nif][delta]
+//   entrada ESVAZIAR:    [4]
+//
+// As sequencias nao vao nos dados: sao seguidas (sem buracos), por isso cada
+// entrada tem a sequencia seguinte a da anterior. Consultas seguidas ao mesmo
+// NIF vao numa so entrada CONSULTAS com delta > 1 (que ocupa 'delta'
+// sequencias).
+// ============================================================================
+std::optional<std::string> RegistoAlteracoes::codificarDesde(unsigned long long desde) const {
+	unsigned long long primeiraGuardada = alteracoes.empty() ? sequencia + 1 : alteracoes.front().sequencia;
+	if (desde > sequencia || desde + 1 < primeiraGuardada) {
+		return std::nullopt;	// replica a frente (outro armario?) ou atrasada demais
+	}
+
+	size_t inicio = (size_t)(desde + 1 - primeiraGuardada);
+
+	std::string corpo;
+	unsigned long long numEntradas = 0;
+	for (size_t i = inicio; i < alteracoes.size(); i++) {
+		const Alteracao& a = alteracoes[i];
+		corpo.push_back((char)a.tipo);
+		numEntradas++;
+
+		switch (a.tipo) {
+		case Tipo::ACRESCENTAR:
+			escreverVarint(corpo, (unsigned)a.nif);
+			escreverVarint(corpo, a.nome.size());
+			corpo += a.nome;
+			escreverVarint(corpo, (unsigned)a.valor);
+			break;
+		case Tipo::APAGAR:
+			escreverVarint(corpo, (unsigned)a.nif);
+			break;
+		case Tipo::CONSULTAS: {
+			unsigned long long delta = a.valor;
+			while (i + 1 < alteracoes.size() && alteracoes[i + 1].tipo == Tipo::CONSULTAS && alteracoes[i + 1].nif == a.nif
+				&& delta + alteracoes[i + 1].valor <= (unsigned long long)MAX_CONSULTAS) {
+				delta += alteracoes[++i].valor;
+			}
+			escreverVarint(corpo, (unsigned)a.nif);
+			escreverVarint(corpo, delta);
+			break;
+		}
+		case Tipo::ESVAZIAR:
+			break;
+		}
+	}
+
+	std::string saida;
+	saida.push_back((char)VERSAO_FORMATO);
+	escreverVarint(saida, desde + 1);
+	escreverVarint(saida, numEntradas);
+	saida += corpo;
+	return saida;
+}
+
+bool RegistoAlteracoes::descodificar(std::string_view dados, std::vector<Alteracao>& resultado) {
+	resultado.clear();
+	size_t pos = 0;
+	unsigned long long seq, numEntradas;
+
+	if (dados.empty() || (unsigned char)dados[pos++] != VERSAO_FORMATO
+		|| !lerVarint(dados, pos, seq) || !lerVarint(dados, pos, numEntradas)) {
+		return false;
+	}
+
+	for (unsigned long long e = 0; e < numEntradas; e++) {
+		if (pos >= dados.size()) {
+			return false;
+		}
+		Alteracao a{ seq, (Tipo)dados[pos++], 0, 0, std::string() };
+
+		switch (a.tipo) {
+		case Tipo::ACRESCENTAR: {
+			unsigned long long tamanho;
+			if (!lerNIF(dados, pos, a.nif) || !lerVarint(dados, pos, tamanho) || tamanho > dados.size() - pos) {
+				return false;
+			}
+			a.nome = std::string(dados.substr(pos, (size_t)tamanho));
+			pos += (size_t)tamanho;
+			if (!lerContagem(dados, pos, a.valor)) {
+				return false;
+			}
+			seq++;
+			break;
+		}
+		case Tipo::APAGAR:
+			if (!lerNIF(dados, pos, a.nif)) {
+				return false;
+			}
+			seq++;
+			break;
+		case Tipo::CONSULTAS:
+			if (!lerNIF(dados, pos, a.nif) || !lerContagem(dados, pos, a.valor) || a.valor == 0) {
+				return false;
+			}
+			seq += (unsigned long long)a.valor;
+			break;
+		case Tipo::ESVAZIAR:
+			seq++;
+			break;
+		default:
+			return false;
+		}
+		resultado.push_back(std::move(a));
+	}
+	return pos == dados.size();
+}
@@ -0,0 +1,88 @@
+#pragma once
+#include <deque>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// ============================================================================
+// REGISTO DE ALTERACOES (change feed)
+// ============================================================================
+// Cada alteracao a um ArmarioFichas recebe um numero de sequencia que so
+// aumenta (1, 2, 3, ...) e fica guardada aqui:
+//
+//   seq:   41          42          43          44
+//          [+ Joao 111][consulta 111][consulta 111][- 222]
+//
+// Uma replica que ja aplicou ate a sequencia 41 pede "tudo desde 41" e recebe
+// so as alteracoes 42..44, numa codificacao binaria compacta (ver
+// codificarDesde), em vez de copiar o armario inteiro com operator=.
+//
+// So se guardam as ultimas MAX_ALTERACOES. Uma replica mais atrasada do que
+// isso tem de voltar a ser copiada por inteiro.
+//
+// Guardar cada alteracao (com uma copia do nome) custa memoria e tempo em
+// todas as operacoes, por isso o registo esta desativado por omissao: a
+// sequencia continua a contar, mas nada e guardado e codificarDesde so
+// responde a uma replica que ja esta em dia.
+//
+// Cada entrada leva no maximo MAX_CONSULTAS consultas (iniciais ou delta):
+// ao codificar, um grupo maior de consultas ao mesmo NIF sai em varias
+// entradas, e ao descodificar um numero maior e dado como mal formado (quem
+// aplica repete as consultas uma a uma, ver ArmarioFichas::aplicarAlteracoes).
+// ============================================================================
+class RegistoAlteracoes
+{
+public:
+	static const int MAX_CONSULTAS = 100000;	// consultas (iniciais ou delta) numa so entrada
+
+	enum class Tipo : unsigned char {
+		ACRESCENTAR = 1,	// novo cliente (nome, NIF, consultas iniciais)
+		APAGAR = 2,			// cliente apagado
+		CONSULTAS = 3,		// +delta consultas (uma alteracao por consulta; agrupadas so ao codificar)
+		ESVAZIAR = 4		// armario esvaziado
+	};
+
+	struct Alteracao {
+		unsigned long long sequencia;
+		Tipo tipo;
+		int nif;
+		int valor;			// ACRESCENTAR: consultas iniciais / CONSULTAS: delta
+		std::string nome;	// so em ACRESCENTAR
+	};
+
+private:
+	static const size_t MAX_ALTERACOES = 1 << 20;
+
+	std::deque<Alteracao> alteracoes;	// as mais recentes, por ordem de sequencia
+	unsigned long long sequencia;		// sequencia da ultima alteracao
+	bool ativo;							// guardar as alteracoes (so a sequencia conta se false)
+
+	void guardar(Tipo tipo, int nif, int valor, std::string_view nome);
+
+public:
+	//Construtor (desativado; a proxima alteracao tera a sequencia 'sequenciaInicial' + 1)
+	explicit RegistoAlteracoes(unsigned long long sequenciaInicial = 0);
+
+	//Ativar/desativar (desativar apaga as alteracoes guardadas; a sequencia continua)
+	void ativar(bool ativoP);
+	bool estaAtivo() const { return ativo; }
+
+	//Registar alteracoes
+	void acrescentado(std::string_view nome, int nif, int consultas) { guardar(Tipo::ACRESCENTAR, nif, consultas, nome); }
+	void apagado(int nif) { guardar(Tipo::APAGAR, nif, 0, std::string_view()); }
+	void consulta(int nif) { guardar(Tipo::CONSULTAS, nif, 1, std::string_view()); }
+	void esvaziado() { guardar(Tipo::ESVAZIAR, 0, 0, std::string_view()); }
+
+	//Esquecer as alteracoes e continuar a partir de 'sequenciaInicial'
+	void recomecar(unsigned long long sequenciaInicial);
+
+	//Getter
+	unsigned long long getSequencia() const { return sequencia; }
+
+	//Alteracoes com sequencia > 'desde', codificadas (vazio se ja nao estao todas guardadas)
+	std::optional<std::string> codificarDesde(unsigned long long desde) const;
+
+	//Descodificar (false se os dados estiverem mal formados, incluindo NIFs que nao cabem num int e consultas > MAX_CONSULTAS)
+	static bool descodificar(std::string_view dados, std::vector<Alteracao>& resultado);
+};
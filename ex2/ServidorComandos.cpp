@@ -0,0 +1,587 @@
+#include "ServidorComandos.h"
+#include "LeituraTexto.h"
+#include "../comum/Instrumentacao.h"
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <cerrno>
+#include <csignal>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+	const size_t TAMANHO_LEITURA = 64 * 1024;	// maximo lido de cada vez (um lote)
+	const size_t MAX_LINHA = 64 * 1024;			// mais do que isto sem '\n': ERR linha e fim da ligacao
+	const size_t CAPACIDADE_FILAS = 2;			// lotes a espera entre duas etapas
+#ifdef INDICE_NIF_DIRETO
+	const size_t MIN_GETS_EM_LOTE = SIZE_MAX;	// cada GET ja e O(1): nunca agrupar
+#else
+	const size_t MIN_GETS_EM_LOTE = 32;			// menos GETs seguidos: uma procura por NIF
+#endif
+
+	// ========================================================================
+	// FILA LIMITADA
+	// ========================================================================
+	// Liga duas etapas: uma coloca, a outra retira. Se a etapa seguinte se
+	// atrasar, a fila enche e a anterior espera (nao se le a entrada toda
+	// para a memoria). fechar() avisa que nao vem mais nada; depois disso
+	// colocar() ja nao espera e devolve false (a etapa seguinte parou).
+	// ========================================================================
+	template <typename T>
+	class FilaLimitada {
+		std::mutex trinco;
+		std::condition_variable mudou;
+		std::deque<T> elementos;
+		size_t capacidade;
+		bool fechada;
+
+	public:
+		FilaLimitada(size_t capacidadeP) : capacidade(capacidadeP), fechada(false) {}
+
+		bool colocar(T elemento) {
+			std::unique_lock<std::mutex> l(trinco);
+			mudou.wait(l, [&] { return elementos.size() < capacidade || fechada; });
+			if (fechada) {
+				return false;
+			}
+			elementos.push_back(std::move(elemento));
+			mudou.notify_all();
+			return true;
+		}
+
+		// Vazio quando a fila esta fechada e ja nao tem elementos
+		std::optional<T> retirar() {
+			std::unique_lock<std::mutex> l(trinco);
+			mudou.wait(l, [&] { return !elementos.empty() || fechada; });
+			if (elementos.empty()) {
+				return std::nullopt;
+			}
+			T elemento = std::move(elementos.front());
+			elementos.pop_front();
+			mudou.notify_all();
+			return elemento;
+		}
+
+		void fechar() {
+			std::lock_guard<std::mutex> l(trinco);
+			fechada = true;
+			mudou.notify_all();
+		}
+	};
+
+	// ========================================================================
+	// ETAPAS (threads do servir)
+	// ========================================================================
+	// Uma excecao numa etapa (ex: std::bad_alloc a montar uma resposta grande)
+	// nao pode deixar threads por juntar (o destrutor de std::thread chamaria
+	// std::terminate) nem ficar perdida:
+	//   - Numa thread: e guardada (so a primeira) e chama-se parar()
+	//   - Na thread do servir: o destrutor chama parar() e junta as threads
+	// juntar() espera por todas e relanca a excecao guardada.
+	//
+	// parar() fecha as filas e acorda as threads bloqueadas a ler/escrever.
+	// ========================================================================
+	class Etapas {
+		std::vector<std::thread> threads;
+		std::function<void()> parar;
+		std::mutex trinco;
+		std::exception_ptr erro;
+
+		void esperarTodas() {
+			for (std::thread& t : threads) {
+				if (t.joinable()) {
+					t.join();
+				}
+			}
+		}
+
+	public:
+		explicit Etapas(std::function<void()> pararP) : parar(std::move(pararP)) {}
+
+		~Etapas() {
+			bool aCorrer = false;
+			for (const std::thread& t : threads) {
+				aCorrer = aCorrer || t.joinable();
+			}
+			if (aCorrer) {
+				parar();
+				esperarTodas();
+			}
+		}
+
+		template <typename F>
+		void lancar(F f) {
+			threads.emplace_back([this, f] {
+				try {
+					f();
+				}
+				catch (...) {
+					{
+						std::lock_guard<std::mutex> l(trinco);
+						if (!erro) {
+							erro = std::current_exception();
+						}
+					}
+					parar();
+				}
+			});
+		}
+
+		void juntar() {
+			esperarTodas();
+			if (erro) {
+				std::rethrow_exception(erro);
+			}
+		}
+	};
+
+	// Ler ate 'tamanho' bytes (0 = fim da entrada, < 0 = erro)
+	long long lerBytes(int descritor, char* destino, size_t tamanho) {
+#ifdef _WIN32
+		return _read(descritor, destino, (unsigned)tamanho);
+#else
+		while (true) {
+			ssize_t n = read(descritor, destino, tamanho);
+			if (n >= 0 || errno != EINTR) {
+				return n;
+			}
+		}
+#endif
+	}
+
+	// Escrever tudo (uma escrita chega quase sempre; false se a saida fechou)
+	bool escreverTudo(int descritor, const char* dados, size_t tamanho) {
+		while (tamanho > 0) {
+#ifdef _WIN32
+			long long n = _write(descritor, dados, (unsigned)tamanho);
+#else
+			ssize_t n = write(descritor, dados, tamanho);
+			if (n < 0 && errno == EINTR) {
+				continue;
+			}
+#endif
+			if (n <= 0) {
+				return false;
+			}
+			dados += n;
+			tamanho -= (size_t)n;
+		}
+		return true;
+	}
+
+#ifndef _WIN32
+	// Antes do bind: 'caminho' tem de estar livre. So se apaga um socket que
+	// ficou de uma execucao anterior (ninguem responde a um connect); um
+	// ficheiro normal, ou o socket de outro servidor ativo, ficam como estao
+	// e lancam std::runtime_error
+	void libertarCaminho(const std::string& caminho, const sockaddr_un& endereco) {
+		struct stat info;
+		if (lstat(caminho.c_str(), &info) != 0) {
+			return;		// nao existe
+		}
+		if (!S_ISSOCK(info.st_mode)) {
+			throw std::runtime_error("Ja existe um ficheiro que nao e um socket em " + caminho);
+		}
+
+		int teste = socket(AF_UNIX, SOCK_STREAM, 0);
+		if (teste < 0) {
+			throw std::runtime_error("Nao foi possivel criar o socket");
+		}
+		bool recusado = connect(teste, (const sockaddr*)&endereco, sizeof(endereco)) != 0 && errno == ECONNREFUSED;
+		close(teste);
+		if (!recusado) {
+			throw std::runtime_error("Ja ha um servidor a escutar em " + caminho);
+		}
+		if (unlink(caminho.c_str()) != 0) {
+			throw std::runtime_error("Nao foi possivel apagar o socket antigo em " + caminho);
+		}
+	}
+#endif
+
+	enum class Tipo { ACRESCENTAR, APAGAR, CONSULTA, DADOS, LISTAGEM, METRICAS, METRICAS_JSON, INVALIDO, LINHA_LONGA };
+
+	// Um comando ja separado (o nome fica no texto do lote: inicio e tamanho)
+	struct Comando {
+		Tipo tipo;
+		int nif;
+		size_t inicioNome;
+		size_t tamanhoNome;
+	};
+
+	struct Lote {
+		std::string texto;				// linhas inteiras, tal como foram lidas
+		std::vector<Comando> comandos;
+	};
+
+	// ========================================================================
+	// SEPARAR
+	// ========================================================================
+	// Cada linha: palavra do comando, espaco, NIF e (so no ADD) espaco + nome
+	// ate ao fim da linha (o nome pode ter espacos):
+	//
+	//   ADD 123456789 Joao Silva\r\n
+	//   |-| |--nif--| |--nome--|
+	//
+	// Linhas vazias sao ignoradas (nao tem resposta).
+	// ========================================================================
+	void separar(Lote& lote) {
+		const char* dados = lote.texto.data();
+		const char* fimDados = dados + lote.texto.size();
+		const char* p = dados;
+
+		while (p < fimDados) {
+			const char* fimLinha = (const char*)memchr(p, '\n', fimDados - p);
+			if (fimLinha == nullptr) {
+				fimLinha = fimDados;
+			}
+			const char* proxima = fimLinha < fimDados ? fimLinha + 1 : fimLinha;
+			if (fimLinha > p && fimLinha[-1] == '\r') {
+				fimLinha--;
+			}
+			if (fimLinha == p) {
+				p = proxima;
+				continue;
+			}
+
+			const char* espaco = (const char*)memchr(p, ' ', fimLinha - p);
+			std::string_view palavra(p, (espaco != nullptr ? espaco : fimLinha) - p);
+			const char* argumentos = espaco != nullptr ? espaco + 1 : fimLinha;
+
+			Comando c{ Tipo::INVALIDO, 0, 0, 0 };
+			if (palavra == "LIST") {
+				if (espaco == nullptr) {
+					c.tipo = Tipo::LISTAGEM;
+				}
+			}
+			else if (palavra == "METRICS") {
+				if (espaco == nullptr) {
+					c.tipo = Tipo::METRICAS;
+				}
+				else if (std::string_view(argumentos, fimLinha - argumentos) == "JSON") {
+					c.tipo = Tipo::METRICAS_JSON;
+				}
+			}
+			else if (palavra == "ADD") {
+				const char* fimNIF = (const char*)memchr(argumentos, ' ', fimLinha - argumentos);
+				if (fimNIF != nullptr && fimNIF + 1 < fimLinha && LeituraTexto::lerInteiro(argumentos, fimNIF, c.nif)) {
+					c.tipo = Tipo::ACRESCENTAR;
+					c.inicioNome = (size_t)(fimNIF + 1 - dados);
+					c.tamanhoNome = (size_t)(fimLinha - (fimNIF + 1));
+				}
+			}
+			else if (LeituraTexto::lerInteiro(argumentos, fimLinha, c.nif)) {
+				if (palavra == "DEL") {
+					c.tipo = Tipo::APAGAR;
+				}
+				else if (palavra == "VISIT") {
+					c.tipo = Tipo::CONSULTA;
+				}
+				else if (palavra == "GET") {
+					c.tipo = Tipo::DADOS;
+				}
+			}
+			lote.comandos.push_back(c);
+			p = proxima;
+		}
+	}
+
+	void responderDados(std::string& respostas, int nif, const std::optional<ArmarioFichas::VistaCliente>& vista) {
+		if (!vista) {
+			respostas += "ERR inexistente\n";
+			return;
+		}
+		respostas += "OK ";
+		respostas += vista->getNomeCliente();
+		respostas += " / ";
+		respostas += std::to_string(nif);
+		respostas += " / ";
+		respostas += std::to_string(vista->getNumConsultas());
+		respostas += '\n';
+	}
+
+	// ========================================================================
+	// EXECUTAR
+	// ========================================================================
+	// Aplica os comandos do lote pela ordem, juntando as respostas num so
+	// texto. Uma sequencia de GETs sem alteracoes pelo meio e respondida com
+	// uma so procura em lote:
+	//
+	//   comandos -> [ADD 5][GET 1][GET 2]...[GET 40][VISIT 2][GET 2]
+	//                       |------ obterDados ------|        verDados
+	//
+	// A procura em lote percorre o armario todo uma vez, por isso so compensa
+	// a partir de ~32 GETs seguidos (medido com 10^3 a 10^6 clientes: 16 GETs
+	// sao mais rapidos um a um e 64 em lote). Com INDICE_NIF_DIRETO cada GET
+	// ja e O(1) e os GETs nunca sao agrupados.
+	//
+	// Devolve o numero de comandos invalidos.
+	// ========================================================================
+	long long executar(ArmarioFichas& armario, const Lote& lote, std::string& respostas) {
+		const std::vector<Comando>& cs = lote.comandos;
+		long long invalidos = 0;
+		std::vector<int> nifs;
+
+		size_t i = 0;
+		while (i < cs.size()) {
+			const Comando& c = cs[i];
+
+			if (c.tipo == Tipo::DADOS) {
+				size_t fim = i + 1;
+				while (fim < cs.size() && cs[fim].tipo == Tipo::DADOS) {
+					fim++;
+				}
+				if (fim - i < MIN_GETS_EM_LOTE) {
+					for (size_t k = i; k < fim; k++) {
+						responderDados(respostas, cs[k].nif, armario.verDados(cs[k].nif));
+					}
+				}
+				else {
+					nifs.clear();
+					for (size_t k = i; k < fim; k++) {
+						nifs.push_back(cs[k].nif);
+					}
+					std::vector<std::optional<ArmarioFichas::VistaCliente>> vistas = armario.obterDados(nifs);
+					for (size_t k = 0; k < vistas.size(); k++) {
+						responderDados(respostas, nifs[k], vistas[k]);
+					}
+				}
+				i = fim;
+				continue;
+			}
+
+			switch (c.tipo) {
+			case Tipo::ACRESCENTAR:
+				respostas += armario.acrescentarClientes(lote.texto.substr(c.inicioNome, c.tamanhoNome), c.nif) ? "OK\n" : "ERR duplicado\n";
+				break;
+			case Tipo::APAGAR:
+				respostas += armario.apagarCliente(c.nif) ? "OK\n" : "ERR inexistente\n";
+				break;
+			case Tipo::CONSULTA:
+				respostas += armario.registarConsulta(c.nif) ? "OK\n" : "ERR inexistente\n";
+				break;
+			case Tipo::LISTAGEM:
+				respostas += "OK " + std::to_string(armario.getNumClientes()) + "\n";
+				armario.acrescentarListagem(respostas);
+				break;
+			case Tipo::METRICAS:
+			case Tipo::METRICAS_JSON: {
+				// Instrumentacao (ver comum/Instrumentacao.h): vazia se nao estiver ligada
+				std::string metricas = c.tipo == Tipo::METRICAS ? Instrumentacao::exportarTexto() : Instrumentacao::exportarJSON();
+				respostas += "OK " + std::to_string(std::count(metricas.begin(), metricas.end(), '\n')) + "\n";
+				respostas += metricas;
+				break;
+			}
+			case Tipo::LINHA_LONGA:
+				respostas += "ERR linha\n";
+				invalidos++;
+				break;
+			default:
+				respostas += "ERR comando\n";
+				invalidos++;
+				break;
+			}
+			i++;
+		}
+		return invalidos;
+	}
+}
+
+std::string ServidorComandos::Relatorio::obtemDesc() const {
+	return std::to_string(comandos) + " comandos / " + std::to_string(invalidos) + " invalidos / "
+		+ std::to_string(lotes) + " lotes / " + std::to_string((long long)getComandosPorSegundo()) + " comandos/s";
+}
+
+// ============================================================================
+// SERVIR
+// ============================================================================
+//   thread leitora:   read() -> [linhas inteiras] -> separar -> fila 'lotes'
+//   esta thread:      fila 'lotes' -> executar -> fila 'respostas'
+//   thread escritora: fila 'respostas' -> uma write() por lote
+//
+// Uma excecao em qualquer etapa fecha as filas, espera pelas threads e sai
+// de servir() (ver Etapas). Uma leitora bloqueada num pipe so termina com o
+// fim da entrada; num socket e acordada com shutdown().
+//
+// Uma linha que ficou a meio numa leitura fica guardada e vai no lote
+// seguinte. Se a saida fechar (o cliente desligou), as respostas seguintes
+// sao descartadas, mas a entrada continua a ser lida ate ao fim.
+//
+// Um cliente que envie mais de MAX_LINHA bytes sem '\n' recebe "ERR linha"
+// (depois das respostas aos comandos anteriores) e deixa de ser lido, para
+// nao ocupar memoria sem limite.
+// ============================================================================
+ServidorComandos::Relatorio ServidorComandos::servir(ArmarioFichas& armario, int entrada, int saida) {
+	auto inicio = std::chrono::steady_clock::now();
+
+	FilaLimitada<Lote> lotes(CAPACIDADE_FILAS);
+	FilaLimitada<std::string> respostas(CAPACIDADE_FILAS);
+
+	Etapas etapas([&] {
+		lotes.fechar();
+		respostas.fechar();
+#ifndef _WIN32
+		shutdown(entrada, SHUT_RD);		// num pipe falha sem efeito (ENOTSOCK)
+		shutdown(saida, SHUT_WR);
+#endif
+	});
+
+	etapas.lancar([&] {
+		std::string acumulado;
+		while (true) {
+			size_t antes = acumulado.size();
+			acumulado.resize(antes + TAMANHO_LEITURA);
+			long long n = lerBytes(entrada, &acumulado[antes], TAMANHO_LEITURA);
+			acumulado.resize(antes + (size_t)(n > 0 ? n : 0));
+			if (n <= 0) {
+				break;
+			}
+
+			size_t ultimaLinha = acumulado.rfind('\n');
+			if (ultimaLinha != std::string::npos) {
+				Lote lote;
+				lote.texto.assign(acumulado, 0, ultimaLinha + 1);
+				acumulado.erase(0, ultimaLinha + 1);
+				separar(lote);
+				if (!lotes.colocar(std::move(lote))) {
+					return;		// o servir parou
+				}
+			}
+			if (acumulado.size() > MAX_LINHA) {
+				Lote lote;
+				lote.comandos.push_back(Comando{ Tipo::LINHA_LONGA, 0, 0, 0 });
+				lotes.colocar(std::move(lote));
+				acumulado = std::string();
+				break;
+			}
+		}
+		if (!acumulado.empty()) {
+			Lote lote;	// ultima linha sem '\n'
+			lote.texto = std::move(acumulado);
+			separar(lote);
+			lotes.colocar(std::move(lote));
+		}
+		lotes.fechar();
+	});
+
+	etapas.lancar([&] {
+		bool aberta = true;
+		while (std::optional<std::string> r = respostas.retirar()) {
+			if (aberta) {
+				aberta = escreverTudo(saida, r->data(), r->size());
+			}
+		}
+	});
+
+	long long comandos = 0, invalidos = 0, numLotes = 0;
+	while (std::optional<Lote> lote = lotes.retirar()) {
+		if (lote->comandos.empty()) {
+			continue;
+		}
+		std::string r;
+		invalidos += executar(armario, *lote, r);
+		comandos += (long long)lote->comandos.size();
+		numLotes++;
+		respostas.colocar(std::move(r));
+	}
+	respostas.fechar();
+
+	etapas.juntar();
+
+	double segundos = std::chrono::duration<double>(std::chrono::steady_clock::now() - inicio).count();
+	return Relatorio(comandos, invalidos, numLotes, segundos);
+}
+
+// ============================================================================
+// ESCUTAR (socket Unix)
+// ============================================================================
+// Cria o socket em 'caminho' e atende cada ligacao com servir(), ate ao fim
+// dessa ligacao. Um socket que tenha ficado de uma execucao anterior e
+// apagado; se 'caminho' for outra coisa (um ficheiro, o socket de outro
+// servidor ativo) nada e apagado (ver libertarCaminho). No fim so se apaga o
+// socket criado aqui (se entretanto foi substituido, fica).
+// O SIGPIPE e ignorado: um cliente que desliga a meio so faz a escrita falhar.
+// Erros ao criar o socket lancam std::runtime_error.
+// ============================================================================
+ServidorComandos::Relatorio ServidorComandos::escutar(ArmarioFichas& armario, const std::string& caminho, int numLigacoes) {
+#ifdef _WIN32
+	(void)armario;
+	(void)caminho;
+	(void)numLigacoes;
+	throw std::runtime_error("Sockets Unix nao suportados neste sistema (usar servir com stdin/stdout)");
+#else
+	sockaddr_un endereco{};
+	endereco.sun_family = AF_UNIX;
+	if (caminho.size() >= sizeof(endereco.sun_path)) {
+		throw std::runtime_error("Caminho do socket demasiado longo: " + caminho);
+	}
+	std::memcpy(endereco.sun_path, caminho.c_str(), caminho.size() + 1);
+
+	int servidor = socket(AF_UNIX, SOCK_STREAM, 0);
+	if (servidor < 0) {
+		throw std::runtime_error("Nao foi possivel criar o socket");
+	}
+	try {
+		libertarCaminho(caminho, endereco);
+	}
+	catch (...) {
+		close(servidor);
+		throw;
+	}
+	if (bind(servidor, (sockaddr*)&endereco, sizeof(endereco)) != 0) {
+		close(servidor);
+		throw std::runtime_error("Nao foi possivel escutar em " + caminho);
+	}
+	// O socket criado (para no fim nao apagar outro que o tenha substituido)
+	struct stat criado;
+	if (lstat(caminho.c_str(), &criado) != 0 || listen(servidor, 16) != 0) {
+		close(servidor);
+		unlink(caminho.c_str());
+		throw std::runtime_error("Nao foi possivel escutar em " + caminho);
+	}
+	std::signal(SIGPIPE, SIG_IGN);
+
+	long long comandos = 0, invalidos = 0, numLotes = 0;
+	double segundos = 0;
+	for (int n = 0; numLigacoes < 0 || n < numLigacoes; n++) {
+		int ligacao = accept(servidor, nullptr, nullptr);
+		if (ligacao < 0) {
+			if (errno == EINTR) {
+				n--;
+				continue;
+			}
+			break;
+		}
+		Relatorio r = servir(armario, ligacao, ligacao);
+		close(ligacao);
+		comandos += r.getComandos();
+		invalidos += r.getInvalidos();
+		numLotes += r.getLotes();
+		segundos += r.getSegundos();
+	}
+
+	close(servidor);
+	struct stat atual;
+	if (lstat(caminho.c_str(), &atual) == 0 && atual.st_dev == criado.st_dev && atual.st_ino == criado.st_ino) {
+		unlink(caminho.c_str());
+	}
+	return Relatorio(comandos, invalidos, numLotes, segundos);
+#endif
+}
@@ -0,0 +1,78 @@
+#pragma once
+#include "ArmarioFichas.h"
+#include <string>
+
+// ============================================================================
+// SERVIDOR DE COMANDOS
+// ============================================================================
+// Atende o protocolo de texto do software da clinica, um comando por linha:
+//
+//   ADD <nif> <nome>    ->  OK | ERR duplicado
+//   DEL <nif>           ->  OK | ERR inexistente
+//   VISIT <nif>         ->  OK | ERR inexistente
+//   GET <nif>           ->  OK <nome> / <nif> / <consultas> | ERR inexistente
+//   LIST                ->  OK <n>, seguido das n linhas da listagem
+//   METRICS             ->  OK <n>, seguido das n linhas de Instrumentacao::exportarTexto()
+//   METRICS JSON        ->  OK 1, seguido de Instrumentacao::exportarJSON() (uma linha)
+//   (outra coisa)       ->  ERR comando
+//   (linha > 64 KB)     ->  ERR linha, e a ligacao termina
+//
+// Cada comando tem exatamente uma resposta, pela mesma ordem (o cliente pode
+// enviar muitos comandos sem esperar pelas respostas: "pipelining").
+//
+// O trabalho esta dividido em 3 etapas, cada uma na sua thread, ligadas por
+// filas curtas. Enquanto um lote e executado, o seguinte ja esta a ser lido
+// e o anterior a ser escrito:
+//
+//   ler + separar (lote 3) -> executar (lote 2) -> escrever (lote 1)
+//
+//   - Um lote = tudo o que uma leitura devolveu (ate 64 KB, linhas inteiras)
+//   - Muitos GETs seguidos no mesmo lote sao respondidos com uma so passagem
+//     pelo armario (ArmarioFichas::obterDados em lote)
+//   - As respostas de um lote inteiro saem numa so escrita
+//
+// So a thread "executar" mexe no armario, por isso os comandos sao aplicados
+// pela ordem em que chegaram.
+//
+// Exemplo de uso:
+//   ArmarioFichas armario;
+//   ServidorComandos::Relatorio r = ServidorComandos::servir(armario, 0, 1);	// stdin -> stdout
+//   std::cerr << r.obtemDesc() << std::endl;
+//
+//   $ printf 'ADD 111 Joao\nVISIT 111\nGET 111\n' | ex2 --servidor
+//   OK
+//   OK
+//   OK Joao / 111 / 1
+// ============================================================================
+class ServidorComandos
+{
+public:
+	class Relatorio {
+		long long comandos;		// comandos respondidos (incluindo os invalidos)
+		long long invalidos;	// linhas que nao sao um comando conhecido
+		long long lotes;		// lotes executados (= escritas das respostas)
+		double segundos;		// tempo total ate ao fim da entrada
+
+	public:
+		//Construtor
+		Relatorio(long long comandosP, long long invalidosP, long long lotesP, double segundosP) :
+			comandos(comandosP), invalidos(invalidosP), lotes(lotesP), segundos(segundosP) {}
+
+		//Getters
+		long long getComandos() const { return comandos; }
+		long long getInvalidos() const { return invalidos; }
+		long long getLotes() const { return lotes; }
+		double getSegundos() const { return segundos; }
+		double getComandosPorSegundo() const { return segundos > 0 ? comandos / segundos : 0; }
+		double getComandosPorLote() const { return lotes > 0 ? (double)comandos / lotes : 0; }
+
+		//Descricao (uma linha, para mostrar ao utilizador)
+		std::string obtemDesc() const;
+	};
+
+	//Atender os comandos lidos de 'entrada' ate ao fim, escrevendo as respostas em 'saida' (descritores de ficheiro)
+	static Relatorio servir(ArmarioFichas& armario, int entrada, int saida);
+
+	//Atender ligacoes num socket Unix em 'caminho', uma de cada vez (numLigacoes < 0: para sempre)
+	static Relatorio escutar(ArmarioFichas& armario, const std::string& caminho, int numLigacoes = -1);
+};
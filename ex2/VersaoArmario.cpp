@@ -0,0 +1,24 @@
+#include "VersaoArmario.h"
+#include <algorithm>
+
+VersaoArmario::VersaoArmario(std::vector<Ficha> fichasP, std::string textoListagemP, unsigned long long numeroP) :
+	fichas(std::move(fichasP)), textoListagem(std::move(textoListagemP)), numero(numeroP) {
+	std::sort(fichas.begin(), fichas.end(), [](const Ficha& a, const Ficha& b) {
+		return a.obtemNIF() < b.obtemNIF();
+	});
+}
+
+const VersaoArmario& VersaoArmario::vazia() {
+	static const VersaoArmario versao(std::vector<Ficha>(), std::string(), 0);
+	return versao;
+}
+
+const VersaoArmario::Ficha* VersaoArmario::procurar(int nif) const {
+	auto pos = std::lower_bound(fichas.begin(), fichas.end(), nif, [](const Ficha& f, int n) {
+		return f.obtemNIF() < n;
+	});
+	if (pos == fichas.end() || pos->obtemNIF() != nif) {
+		return nullptr;
+	}
+	return &*pos;
+}
@@ -0,0 +1,61 @@
+#pragma once
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// ============================================================================
+// VERSAO DO ARMARIO (instantaneo imutavel)
+// ============================================================================
+// Copia "congelada" do conteudo de um ArmarioFichas num certo momento.
+// Depois de criada nunca muda, por isso pode ser lida por varias threads ao
+// mesmo tempo, sem bloqueios, enquanto o escritor continua a alterar o
+// armario (e a publicar versoes novas).
+//
+// As fichas estao ordenadas por NIF: procurar e pesquisa binaria e comparar
+// duas versoes e uma so passagem.
+// ============================================================================
+class VersaoArmario
+{
+public:
+	class Ficha {
+		std::string nome;
+		int nif;
+		int numConsultas;
+
+	public:
+		//Construtor
+		Ficha(std::string_view nomeP, int nifP, int numConsultasP) : nome(nomeP), nif(nifP), numConsultas(numConsultasP) {}
+
+		//Getters
+		const std::string& obtemNome() const { return nome; }
+		int obtemNIF() const { return nif; }
+		int obtemNumConsultas() const { return numConsultas; }
+
+		bool operator==(const Ficha& outra) const = default;
+	};
+
+private:
+	std::vector<Ficha> fichas;		// ordenadas por NIF
+	std::string textoListagem;		// listagem do armario no momento da versao
+	unsigned long long numero;		// numero da versao (aumenta a cada publicacao)
+
+public:
+	//Construtor (as fichas sao ordenadas aqui)
+	VersaoArmario(std::vector<Ficha> fichasP, std::string textoListagemP, unsigned long long numeroP);
+
+	//Versao vazia partilhada (para quem le antes de haver alguma publicacao)
+	static const VersaoArmario& vazia();
+
+	//Getters
+	int getNumClientes() const { return (int)fichas.size(); }
+	unsigned long long getNumero() const { return numero; }
+	const std::vector<Ficha>& obtemFichas() const { return fichas; }
+	const std::string& listagem() const { return textoListagem; }
+
+	//Procurar a ficha de um NIF (pesquisa binaria)
+	const Ficha* procurar(int nif) const;
+
+	//Mesmos clientes, com os mesmos dados (independentemente da ordem no armario)
+	bool operator==(const VersaoArmario& outra) const { return fichas == outra.fichas; }
+};
@@ -1,10 +1,31 @@
 // ex2.cpp : This file contains the 'main' function. Program execution begins and ends there.
 //
 
+#include "ArmarioFichas.h"
+#include "ServidorComandos.h"
 #include <iostream>
+#include <stdexcept>
+#include <string>
 
-int main()
+// ex2 --servidor             atende comandos de stdin, respostas em stdout
+// ex2 --servidor <caminho>   atende comandos num socket Unix em <caminho>
+int main(int argc, char** argv)
 {
+    if (argc >= 2 && std::string(argv[1]) == "--servidor") {
+        ArmarioFichas armario;
+        try {
+            ServidorComandos::Relatorio r = argc >= 3
+                ? ServidorComandos::escutar(armario, argv[2])
+                : ServidorComandos::servir(armario, 0, 1);
+            std::cerr << r.obtemDesc() << std::endl;
+        }
+        catch (const std::runtime_error& e) {
+            std::cerr << e.what() << std::endl;
+            return 1;
+        }
+        return 0;
+    }
+
     std::cout << "Hello World!\n";
 }
 
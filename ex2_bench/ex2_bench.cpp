@@ -0,0 +1,812 @@
+// ex2_bench.cpp : Benchmark do ArmarioFichas com cargas realistas.
+//
+// Gera armarios sinteticos de varios tamanhos (10^3 a 10^7 clientes) e mede
+// cada carga de trabalho:
+//   consulta_zipf   registarConsulta com NIFs em distribuicao de Zipf (poucos clientes muito frequentes)
+//   rotacao         acrescentarClientes/apagarCliente alternados (clientes a entrar e a sair)
+//   obter_dados     obterDados com uma percentagem configuravel de NIFs inexistentes
+//   listagem        verListagem() depois de uma alteracao (sem copiar a listagem)
+//   listagem_nome   listagemPorNome() (ordenada por radix sort de cada vez)
+//   copia           construtor por copia
+//   atribuicao      operador de atribuicao
+//   arrefecer       arrefecer() dos clientes sem atividade desde o preenchimento (uma vez)
+//   obter_frio      obterDados const depois do arrefecer (a maior parte lidos do armazem frio, sem promover)
+//   promover        obterDados depois do arrefecer (os frios voltam a ser quentes)
+//
+// Resultado (uma linha por tamanho x carga), em CSV ou JSON (uma linha por objeto):
+//   tamanho,carga,operacoes,ops_por_s,p50_ns,p99_ns,pico_rss_kb
+//
+// Com --memoria, compara so os indices por NIF (IndiceDiretoNIF contra uma
+// std::unordered_map), com NIFs espalhados por todo o intervalo ou seguidos:
+//   tamanho,distribuicao,indice,bytes,bytes_por_nif,ns_por_procura
+//
+// Com --indices, mede o Armario generico com cada politica de indice por NIF
+// (IndiceLinear, IndiceHash, IndiceOrdenado, IndiceDiretoNIF), com os mesmos
+// clientes: acrescentar em lote, procurar, acrescentar e remover um a um:
+//   tamanho,indice,operacao,operacoes,ns_por_op
+//
+// Com --bloom, mede a taxa de falsos positivos do FiltroBloom: o filtro e
+// dimensionado para 'tamanho' NIFs e cheio a metade (como no ArmarioFichas
+// logo apos reconstruir) ou por inteiro (pouco antes de reconstruir); depois
+// pergunta-se por NIFs que nunca la entraram:
+//   tamanho,ocupacao,consultas,falsos_positivos,fpr_pct
+//
+// Com --servidor, e um gerador de carga local para o ServidorComandos: o
+// servidor le os comandos de um pipe e responde noutro, e o "cliente" envia
+// uma mistura de GET/VISIT/ADD/DEL (NIFs em Zipf) de duas maneiras:
+//   pipeline   todos os comandos seguidos, sem esperar pelas respostas
+//   sincrono   um comando de cada vez, esperando pela resposta
+//   tamanho,cliente,pedidos,pedidos_por_s,lotes,pedidos_por_lote
+//
+// Uso:
+//   ex2_bench [--min N] [--max N] [--ops N] [--falhas F] [--zipf T] [--filtro] [--memoria] [--indices] [--bloom] [--servidor] [--json] [--metricas]
+//     --min / --max  tamanhos (potencias de 10) entre min e max   (omissao: 1000 / 100000)
+//     --ops          operacoes por carga                           (omissao: 20000;
+//                    com --max 10000000 convem baixar para ~1000)
+//     --falhas       fracao de NIFs inexistentes em obter_dados    (omissao: 0.5)
+//     --zipf         expoente da distribuicao de Zipf              (omissao: 0.99)
+//     --filtro       ativa o filtro de Bloom de NIFs
+//     --memoria      compara a memoria dos indices por NIF (em vez das cargas)
+//     --indices      mede cada politica de indice do Armario (em vez das cargas)
+//     --bloom        mede os falsos positivos do filtro de Bloom (em vez das cargas)
+//     --servidor     mede pedidos/s do ServidorComandos (em vez das cargas)
+//     --json         escreve JSON em vez de CSV
+//     --metricas     no fim, escreve em stderr as metricas da Instrumentacao (texto,
+//                    ou JSON com --json); so tem dados se compilado com INSTRUMENTACAO
+
+#include "../ex2/Armario.h"
+#include "../ex2/ArmarioFichas.h"
+#include "../ex2/FiltroBloom.h"
+#include "../ex2/IndiceDiretoNIF.h"
+#include "../ex2/ServidorComandos.h"
+#include "../comum/Instrumentacao.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <optional>
+#include <random>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#include <psapi.h>
+#include <fcntl.h>
+#include <io.h>
+#pragma comment(lib, "psapi.lib")
+#else
+#include <sys/resource.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+	struct Opcoes {
+		long long minimo = 1000;
+		long long maximo = 100000;
+		int operacoes = 20000;
+		double falhas = 0.5;
+		double zipf = 0.99;
+		bool filtro = false;
+		bool memoria = false;
+		bool indices = false;
+		bool bloom = false;
+		bool servidor = false;
+		bool json = false;
+		bool metricas = false;
+	};
+
+	// Pico de memoria residente do processo (KB)
+	long long picoRSSKb() {
+#ifdef _WIN32
+		PROCESS_MEMORY_COUNTERS pmc;
+		if (GetProcessMemoryInfo(GetCurrentProcess(), &pmc, sizeof(pmc))) {
+			return (long long)(pmc.PeakWorkingSetSize / 1024);
+		}
+		return 0;
+#else
+		struct rusage uso;
+		getrusage(RUSAGE_SELF, &uso);
+#ifdef __APPLE__
+		return uso.ru_maxrss / 1024;	// macOS devolve bytes
+#else
+		return uso.ru_maxrss;			// Linux devolve KB
+#endif
+#endif
+	}
+
+	// NIF sintetico numero i: 9 digitos, todos diferentes para i < 900000000
+	// (7919 e primo com 900000000, por isso i -> i*7919 mod 900000000 e uma permutacao)
+	int nifSintetico(long long i) {
+		return 100000000 + (int)((i * 7919) % 900000000);
+	}
+
+	// NIF valido (com digito de controlo) a partir dos 8 primeiros digitos
+	int nifValido(int oitoDigitos) {
+		int soma = 0;
+		int resto = oitoDigitos;
+		for (int peso = 2; peso <= 9; peso++) {
+			soma += (resto % 10) * peso;
+			resto /= 10;
+		}
+		int controlo = 11 - soma % 11;
+		return oitoDigitos * 10 + (controlo >= 10 ? 0 : controlo);
+	}
+
+	// ========================================================================
+	// GERADOR DE ZIPF
+	// ========================================================================
+	// Gera ranks 0..n-1 em que o rank k tem probabilidade proporcional a
+	// 1/(k+1)^theta (metodo de Gray et al., usado no YCSB): O(n) uma vez para
+	// calcular zeta(n), depois O(1) por numero, sem tabelas.
+	// ========================================================================
+	class GeradorZipf {
+		long long n;
+		double theta, alpha, zetan, eta;
+
+		static double zeta(long long n, double theta) {
+			double soma = 0;
+			for (long long i = 1; i <= n; i++) {
+				soma += 1.0 / std::pow((double)i, theta);
+			}
+			return soma;
+		}
+
+	public:
+		GeradorZipf(long long nP, double thetaP) : n(nP), theta(thetaP) {
+			zetan = zeta(n, theta);
+			alpha = 1.0 / (1.0 - theta);
+			eta = (1 - std::pow(2.0 / n, 1 - theta)) / (1 - zeta(2, theta) / zetan);
+		}
+
+		long long proximo(std::mt19937_64& gerador) {
+			double u = std::uniform_real_distribution<double>(0, 1)(gerador);
+			double uz = u * zetan;
+			if (uz < 1.0) {
+				return 0;
+			}
+			if (uz < 1.0 + std::pow(0.5, theta)) {
+				return 1;
+			}
+			long long r = (long long)(n * std::pow(eta * u - eta + 1, alpha));
+			return r < n ? r : n - 1;
+		}
+	};
+
+	// Latencias de uma carga -> uma linha de resultados
+	void reportar(const Opcoes& opcoes, long long tamanho, const char* carga, std::vector<long long>& latencias, double segundos) {
+		std::sort(latencias.begin(), latencias.end());
+		size_t n = latencias.size();
+		long long p50 = n ? latencias[n / 2] : 0;
+		long long p99 = n ? latencias[std::min(n - 1, n * 99 / 100)] : 0;
+		long long opsPorSegundo = segundos > 0 ? (long long)(n / segundos) : 0;
+
+		if (opcoes.json) {
+			std::cout << "{\"tamanho\":" << tamanho << ",\"carga\":\"" << carga << "\",\"operacoes\":" << n
+				<< ",\"ops_por_s\":" << opsPorSegundo << ",\"p50_ns\":" << p50 << ",\"p99_ns\":" << p99
+				<< ",\"pico_rss_kb\":" << picoRSSKb() << "}" << std::endl;
+		}
+		else {
+			std::cout << tamanho << "," << carga << "," << n << "," << opsPorSegundo << ","
+				<< p50 << "," << p99 << "," << picoRSSKb() << std::endl;
+		}
+	}
+
+	// Corre 'operacoes' vezes a funcao 'op(i)', medindo cada chamada
+	template <typename Op>
+	void medir(const Opcoes& opcoes, long long tamanho, const char* carga, int operacoes, Op op) {
+		using relogio = std::chrono::steady_clock;
+		std::vector<long long> latencias;
+		latencias.reserve(operacoes);
+
+		auto inicio = relogio::now();
+		for (int i = 0; i < operacoes; i++) {
+			auto t0 = relogio::now();
+			op(i);
+			latencias.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(relogio::now() - t0).count());
+		}
+		double segundos = std::chrono::duration<double>(relogio::now() - inicio).count();
+
+		reportar(opcoes, tamanho, carga, latencias, segundos);
+	}
+
+	// Armario com 'tamanho' clientes sinteticos, criado num so lote
+	void preencher(ArmarioFichas& armario, long long tamanho) {
+		std::vector<std::string> nomes;
+		std::vector<ArmarioFichas::RegistoCliente> registos;
+		nomes.reserve(tamanho);
+		registos.reserve(tamanho);
+		for (long long i = 0; i < tamanho; i++) {
+			nomes.push_back("Cliente " + std::to_string(i));
+		}
+		for (long long i = 0; i < tamanho; i++) {
+			registos.push_back(ArmarioFichas::RegistoCliente{ nomes[i], nifSintetico(i), (int)(i % 7) });
+		}
+		armario.acrescentarLote(registos);
+	}
+
+	void correrTamanho(const Opcoes& opcoes, long long tamanho) {
+		std::mt19937_64 gerador(12345 + tamanho);
+		ArmarioFichas armario;
+		preencher(armario, tamanho);
+		if (opcoes.filtro) {
+			armario.ativarFiltroNIF(true);
+		}
+
+		// NIFs a usar, escolhidos ANTES de medir (o gerador nao entra no tempo)
+		std::vector<int> nifs(opcoes.operacoes);
+
+		GeradorZipf zipf(tamanho, opcoes.zipf);
+		for (int& nif : nifs) {
+			nif = nifSintetico(zipf.proximo(gerador));
+		}
+		medir(opcoes, tamanho, "consulta_zipf", opcoes.operacoes, [&](int i) {
+			armario.registarConsulta(nifs[i]);
+		});
+
+		// Rotacao: operacoes pares acrescentam um cliente novo, impares apagam um existente
+		long long proximoNovo = tamanho;
+		std::uniform_int_distribution<long long> existente(0, tamanho - 1);
+		for (int i = 0; i < opcoes.operacoes; i++) {
+			nifs[i] = i % 2 == 0 ? nifSintetico(proximoNovo++) : nifSintetico(existente(gerador));
+		}
+		medir(opcoes, tamanho, "rotacao", opcoes.operacoes, [&](int i) {
+			if (i % 2 == 0) {
+				armario.acrescentarClientes("Novo", nifs[i]);
+			}
+			else {
+				armario.apagarCliente(nifs[i]);
+			}
+		});
+
+		// Procuras com uma fracao 'falhas' de NIFs que nunca existiram
+		std::bernoulli_distribution falha(opcoes.falhas);
+		for (int& nif : nifs) {
+			nif = falha(gerador) ? nifSintetico(tamanho * 4 + existente(gerador)) : nifSintetico(existente(gerador));
+		}
+		long long encontrados = 0;
+		medir(opcoes, tamanho, "obter_dados", opcoes.operacoes, [&](int i) {
+			encontrados += armario.obterDados(nifs[i]).getNumConsultas();
+		});
+
+		// Listagem depois de cada alteracao (o caso tipico de um painel a consultar)
+		int numListagens = std::max(1, (int)std::min<long long>(opcoes.operacoes, 20000000 / tamanho));
+		size_t bytes = 0;
+		medir(opcoes, tamanho, "listagem", numListagens, [&](int) {
+			armario.registarConsulta(nifSintetico(existente(gerador)));
+			bytes += armario.verListagem().size();
+		});
+
+		// Listagem por nome: a ordem e calculada de cada vez, por isso menos repeticoes
+		int numListagensNome = std::max(1, (int)std::min<long long>(opcoes.operacoes, 2000000 / tamanho));
+		medir(opcoes, tamanho, "listagem_nome", numListagensNome, [&](int) {
+			bytes += armario.listagemPorNome().size();
+		});
+
+		// Copias inteiras: poucas repeticoes nos tamanhos grandes
+		int numCopias = std::max(1, (int)std::min<long long>(200, 2000000 / tamanho));
+		medir(opcoes, tamanho, "copia", numCopias, [&](int) {
+			ArmarioFichas copia(armario);
+			bytes += copia.getNumClientes();
+		});
+
+		ArmarioFichas destino;
+		medir(opcoes, tamanho, "atribuicao", numCopias, [&](int) {
+			destino = armario;
+		});
+
+		// Clientes frios: so os tocados pelas cargas anteriores tiveram atividade
+		// nas ultimas 'operacoes' operacoes (os outros passam ao armazem frio)
+		int numFrios = 0;
+		medir(opcoes, tamanho, "arrefecer", 1, [&](int) {
+			numFrios = armario.arrefecer(opcoes.operacoes);
+		});
+		for (int& nif : nifs) {
+			nif = nifSintetico(existente(gerador));
+		}
+		medir(opcoes, tamanho, "obter_frio", opcoes.operacoes, [&](int i) {
+			encontrados += std::as_const(armario).obterDados(nifs[i]).getNumConsultas();
+		});
+		medir(opcoes, tamanho, "promover", opcoes.operacoes, [&](int i) {
+			encontrados += armario.obterDados(nifs[i]).getNumConsultas();
+		});
+
+		// Impede o compilador de eliminar o trabalho "sem efeito"
+		if (encontrados + (long long)bytes + destino.getNumClientes() + numFrios == -1) {
+			std::cout << "";
+		}
+	}
+
+	// ========================================================================
+	// MEMORIA DOS INDICES POR NIF
+	// ========================================================================
+	// A std::unordered_map usa um alocador que conta os bytes pedidos, por
+	// isso o valor e exato (nos + baldes), tal como o getBytes() das paginas.
+	// ========================================================================
+	size_t bytesContados = 0;
+
+	template <typename T>
+	struct AlocadorContador {
+		using value_type = T;
+
+		AlocadorContador() = default;
+		template <typename U>
+		AlocadorContador(const AlocadorContador<U>&) {}
+
+		T* allocate(size_t n) {
+			bytesContados += n * sizeof(T);
+			return std::allocator<T>().allocate(n);
+		}
+		void deallocate(T* p, size_t n) {
+			bytesContados -= n * sizeof(T);
+			std::allocator<T>().deallocate(p, n);
+		}
+
+		template <typename U>
+		bool operator==(const AlocadorContador<U>&) const { return true; }
+	};
+
+	using MapaContado = std::unordered_map<int, int, std::hash<int>, std::equal_to<int>, AlocadorContador<std::pair<const int, int>>>;
+
+	void reportarMemoria(const Opcoes& opcoes, long long tamanho, const char* distribuicao, const char* indice, size_t bytes, double nsPorProcura) {
+		double porNIF = (double)bytes / (double)tamanho;
+		if (opcoes.json) {
+			std::cout << "{\"tamanho\":" << tamanho << ",\"distribuicao\":\"" << distribuicao << "\",\"indice\":\"" << indice
+				<< "\",\"bytes\":" << bytes << ",\"bytes_por_nif\":" << porNIF << ",\"ns_por_procura\":" << nsPorProcura << "}" << std::endl;
+		}
+		else {
+			std::cout << tamanho << "," << distribuicao << "," << indice << "," << bytes << "," << porNIF << "," << nsPorProcura << std::endl;
+		}
+	}
+
+	// Tempo medio de procurar os NIFs de 'procuras' (ns por procura)
+	template <typename Procurar>
+	double tempoProcuras(const std::vector<int>& procuras, Procurar procurar) {
+		using relogio = std::chrono::steady_clock;
+		long long soma = 0;
+		auto inicio = relogio::now();
+		for (int nif : procuras) {
+			soma += procurar(nif);
+		}
+		double ns = std::chrono::duration<double, std::nano>(relogio::now() - inicio).count();
+		if (soma == -1) {
+			std::cout << "";
+		}
+		return ns / (double)procuras.size();
+	}
+
+	void compararMemoria(const Opcoes& opcoes, long long tamanho) {
+		std::mt19937_64 gerador(777 + tamanho);
+		const char* distribuicoes[] = { "espalhados", "seguidos" };
+
+		for (const char* distribuicao : distribuicoes) {
+			std::vector<int> nifs(tamanho);
+			for (long long i = 0; i < tamanho; i++) {
+				nifs[i] = distribuicao[0] == 'e' ? nifSintetico(i) : nifValido(20000000 + (int)i);
+			}
+			std::vector<int> procuras(opcoes.operacoes);
+			std::uniform_int_distribution<long long> qualquer(0, tamanho - 1);
+			for (int& nif : procuras) {
+				nif = nifs[qualquer(gerador)];
+			}
+
+			IndiceDiretoNIF<int> direto;
+			direto.acrescentadosVarios(nifs, 0);
+			double nsDireto = tempoProcuras(procuras, [&](int nif) { return direto.procurar(nif); });
+			reportarMemoria(opcoes, tamanho, distribuicao, "direto", direto.getBytes(), nsDireto);
+
+			bytesContados = 0;
+			{
+				MapaContado mapa;
+				for (long long i = 0; i < tamanho; i++) {
+					mapa.emplace(nifs[i], (int)i);
+				}
+				size_t bytesMapa = bytesContados;
+				double nsMapa = tempoProcuras(procuras, [&](int nif) { auto p = mapa.find(nif); return p != mapa.end() ? p->second : -1; });
+				reportarMemoria(opcoes, tamanho, distribuicao, "hash", bytesMapa, nsMapa);
+			}
+		}
+	}
+
+	// ========================================================================
+	// POLITICAS DE INDICE DO ARMARIO
+	// ========================================================================
+	// O ArmarioFichas so usa uma politica de cada vez (escolhida ao compilar,
+	// ver ArmarioFichas.h); aqui o Armario generico e instanciado com todas e
+	// cada uma recebe os mesmos clientes e os mesmos NIFs:
+	//   acrescentar_lote  acrescentarVarios com todos os clientes (ns por cliente)
+	//   procurar          posicaoDe de NIFs existentes
+	//   acrescentar       um cliente novo de cada vez (array novo: O(n) em todas)
+	//   remover           procurar + remover um cliente (swap-and-pop, array novo)
+	//
+	// Acrescentar e remover copiam o array de ponteiros inteiro, por isso sao
+	// feitos no maximo ~2*10^8 / tamanho vezes. O IndiceLinear procura em O(n):
+	// nos tamanhos grandes convem baixar --ops.
+	// ========================================================================
+	struct NifDoClienteBench {
+		int operator()(const Cliente& c) const { return c.obtemNIF(); }
+	};
+
+	void reportarIndice(const Opcoes& opcoes, long long tamanho, const char* indice, const char* operacao, long long operacoes, double nsPorOp) {
+		if (opcoes.json) {
+			std::cout << "{\"tamanho\":" << tamanho << ",\"indice\":\"" << indice << "\",\"operacao\":\"" << operacao
+				<< "\",\"operacoes\":" << operacoes << ",\"ns_por_op\":" << nsPorOp << "}" << std::endl;
+		}
+		else {
+			std::cout << tamanho << "," << indice << "," << operacao << "," << operacoes << "," << nsPorOp << std::endl;
+		}
+	}
+
+	template <template <typename> class Indice>
+	void medirIndice(const Opcoes& opcoes, long long tamanho, const char* indice, const std::vector<int>& procuras, const std::vector<int>& apagar) {
+		using relogio = std::chrono::steady_clock;
+		Armario<Cliente, NifDoClienteBench, Indice> armario;
+		int numAlteracoes = (int)apagar.size();
+
+		std::vector<Cliente*> novos;
+		novos.reserve(tamanho);
+		for (long long i = 0; i < tamanho; i++) {
+			novos.push_back(new Cliente("Cliente " + std::to_string(i), nifSintetico(i)));
+		}
+		auto inicio = relogio::now();
+		armario.acrescentarVarios(novos);
+		double ns = std::chrono::duration<double, std::nano>(relogio::now() - inicio).count();
+		reportarIndice(opcoes, tamanho, indice, "acrescentar_lote", tamanho, ns / (double)tamanho);
+
+		ns = tempoProcuras(procuras, [&](int nif) { return armario.posicaoDe(nif); });
+		reportarIndice(opcoes, tamanho, indice, "procurar", (long long)procuras.size(), ns);
+
+		// NIFs novos: a seguir aos do lote
+		novos.clear();
+		for (int k = 0; k < numAlteracoes; k++) {
+			novos.push_back(new Cliente("Novo " + std::to_string(k), nifSintetico(tamanho + k)));
+		}
+		inicio = relogio::now();
+		for (Cliente* novo : novos) {
+			armario.acrescentar(novo);
+		}
+		ns = std::chrono::duration<double, std::nano>(relogio::now() - inicio).count();
+		reportarIndice(opcoes, tamanho, indice, "acrescentar", numAlteracoes, ns / (double)numAlteracoes);
+
+		inicio = relogio::now();
+		for (int nif : apagar) {
+			armario.remover(armario.posicaoDe(nif));
+		}
+		ns = std::chrono::duration<double, std::nano>(relogio::now() - inicio).count();
+		reportarIndice(opcoes, tamanho, indice, "remover", numAlteracoes, ns / (double)numAlteracoes);
+	}
+
+	void compararIndices(const Opcoes& opcoes, long long tamanho) {
+		std::mt19937_64 gerador(555 + tamanho);
+		std::uniform_int_distribution<long long> qualquer(0, tamanho - 1);
+		std::vector<int> procuras(opcoes.operacoes);
+		for (int& nif : procuras) {
+			nif = nifSintetico(qualquer(gerador));
+		}
+
+		// Clientes do lote a apagar, todos diferentes
+		int numAlteracoes = (int)std::max(1LL, std::min<long long>({ (long long)opcoes.operacoes, 200000000 / tamanho, tamanho }));
+		std::vector<long long> posicoes(tamanho);
+		for (long long i = 0; i < tamanho; i++) {
+			posicoes[i] = i;
+		}
+		std::shuffle(posicoes.begin(), posicoes.end(), gerador);
+		std::vector<int> apagar(numAlteracoes);
+		for (int k = 0; k < numAlteracoes; k++) {
+			apagar[k] = nifSintetico(posicoes[k]);
+		}
+
+		medirIndice<IndiceLinear>(opcoes, tamanho, "linear", procuras, apagar);
+		medirIndice<IndiceHash>(opcoes, tamanho, "hash", procuras, apagar);
+		medirIndice<IndiceOrdenado>(opcoes, tamanho, "ordenado", procuras, apagar);
+		medirIndice<IndiceDiretoNIF>(opcoes, tamanho, "direto", procuras, apagar);
+	}
+
+	// ========================================================================
+	// FALSOS POSITIVOS DO FILTRO DE BLOOM
+	// ========================================================================
+	// Os NIFs perguntados (nifSintetico a partir de 4 * tamanho) nunca foram
+	// acrescentados, por isso cada "talvez" e um falso positivo.
+	// ========================================================================
+	void medirFiltroBloom(const Opcoes& opcoes, long long tamanho) {
+		const long long CONSULTAS = 2000000;
+		const int ocupacoes[] = { 50, 100 };
+
+		for (int ocupacao : ocupacoes) {
+			FiltroBloom filtro;
+			filtro.dimensionar((int)tamanho);
+			long long inseridos = tamanho * ocupacao / 100;
+			for (long long i = 0; i < inseridos; i++) {
+				filtro.acrescentar(nifSintetico(i));
+			}
+
+			long long falsos = 0;
+			for (long long i = 0; i < CONSULTAS; i++) {
+				falsos += filtro.podeConter(nifSintetico(4 * tamanho + i)) ? 1 : 0;
+			}
+			double pct = 100.0 * (double)falsos / (double)CONSULTAS;
+
+			if (opcoes.json) {
+				std::cout << "{\"tamanho\":" << tamanho << ",\"ocupacao\":" << ocupacao << ",\"consultas\":" << CONSULTAS
+					<< ",\"falsos_positivos\":" << falsos << ",\"fpr_pct\":" << pct << "}" << std::endl;
+			}
+			else {
+				std::cout << tamanho << "," << ocupacao << "," << CONSULTAS << "," << falsos << "," << pct << std::endl;
+			}
+		}
+	}
+
+	// ========================================================================
+	// GERADOR DE CARGA DO SERVIDOR DE COMANDOS
+	// ========================================================================
+	// Dois pipes ligam o "cliente" (esta thread) ao servidor (outra thread):
+	//
+	//   cliente --comandos--> [pipe] --> ServidorComandos::servir --> [pipe] --respostas--> cliente
+	//
+	// Cada comando tem uma resposta de uma linha (a mistura nao tem LIST),
+	// por isso o cliente so conta '\n' para saber quantas respostas chegaram.
+	// ========================================================================
+#ifdef _WIN32
+	bool criarPipe(int descritores[2]) { return _pipe(descritores, 1 << 16, _O_BINARY) == 0; }
+	long long lerDescritor(int d, char* destino, size_t tamanho) { return _read(d, destino, (unsigned)tamanho); }
+	long long escreverDescritor(int d, const char* dados, size_t tamanho) { return _write(d, dados, (unsigned)tamanho); }
+	void fecharDescritor(int d) { _close(d); }
+#else
+	bool criarPipe(int descritores[2]) { return pipe(descritores) == 0; }
+	long long lerDescritor(int d, char* destino, size_t tamanho) { return read(d, destino, tamanho); }
+	long long escreverDescritor(int d, const char* dados, size_t tamanho) { return write(d, dados, tamanho); }
+	void fecharDescritor(int d) { close(d); }
+#endif
+
+	void escreverTudo(int d, const char* dados, size_t tamanho) {
+		while (tamanho > 0) {
+			long long n = escreverDescritor(d, dados, tamanho);
+			if (n <= 0) {
+				return;
+			}
+			dados += n;
+			tamanho -= (size_t)n;
+		}
+	}
+
+	// Le respostas ate contar 'linhas' fins de linha (ou ate ao fim do pipe)
+	long long lerRespostas(int d, long long linhas) {
+		char buffer[1 << 16];
+		long long contadas = 0;
+		while (contadas < linhas) {
+			long long n = lerDescritor(d, buffer, sizeof(buffer));
+			if (n <= 0) {
+				break;
+			}
+			for (long long i = 0; i < n; i++) {
+				contadas += buffer[i] == '\n';
+			}
+		}
+		return contadas;
+	}
+
+	// Mistura de comandos: 70% GET (10% de NIFs inexistentes), 20% VISIT,
+	// 5% ADD de clientes novos e 5% DEL desses mesmos clientes
+	std::vector<std::string> gerarComandos(const Opcoes& opcoes, long long tamanho, std::mt19937_64& gerador) {
+		GeradorZipf zipf(tamanho, opcoes.zipf);
+		std::uniform_int_distribution<int> percentagem(0, 99);
+		std::vector<std::string> comandos;
+		comandos.reserve(opcoes.operacoes);
+		long long proximoNovo = tamanho * 4;
+		long long proximoApagar = proximoNovo;
+		for (int i = 0; i < opcoes.operacoes; i++) {
+			int p = percentagem(gerador);
+			if (p < 70) {
+				long long k = p < 7 ? tamanho * 2 + zipf.proximo(gerador) : zipf.proximo(gerador);
+				comandos.push_back("GET " + std::to_string(nifSintetico(k)) + "\n");
+			}
+			else if (p < 90) {
+				comandos.push_back("VISIT " + std::to_string(nifSintetico(zipf.proximo(gerador))) + "\n");
+			}
+			else if (p < 95 || proximoApagar == proximoNovo) {
+				comandos.push_back("ADD " + std::to_string(nifSintetico(proximoNovo++)) + " Cliente novo\n");
+			}
+			else {
+				comandos.push_back("DEL " + std::to_string(nifSintetico(proximoApagar++)) + "\n");
+			}
+		}
+		return comandos;
+	}
+
+	void reportarServidor(const Opcoes& opcoes, long long tamanho, const char* cliente, const ServidorComandos::Relatorio& r, double segundos) {
+		long long porSegundo = segundos > 0 ? (long long)(r.getComandos() / segundos) : 0;
+		if (opcoes.json) {
+			std::cout << "{\"tamanho\":" << tamanho << ",\"cliente\":\"" << cliente << "\",\"pedidos\":" << r.getComandos()
+				<< ",\"pedidos_por_s\":" << porSegundo << ",\"lotes\":" << r.getLotes()
+				<< ",\"pedidos_por_lote\":" << r.getComandosPorLote() << "}" << std::endl;
+		}
+		else {
+			std::cout << tamanho << "," << cliente << "," << r.getComandos() << "," << porSegundo << ","
+				<< r.getLotes() << "," << r.getComandosPorLote() << std::endl;
+		}
+	}
+
+	void medirServidor(const Opcoes& opcoes, long long tamanho) {
+		using relogio = std::chrono::steady_clock;
+		std::mt19937_64 gerador(4242 + tamanho);
+		std::vector<std::string> comandos = gerarComandos(opcoes, tamanho, gerador);
+		const char* clientes[] = { "pipeline", "sincrono" };
+
+		for (const char* cliente : clientes) {
+			bool pipeline = cliente[0] == 'p';
+			ArmarioFichas armario;
+			preencher(armario, tamanho);
+			if (opcoes.filtro) {
+				armario.ativarFiltroNIF(true);
+			}
+
+			int pedidos[2], respostas[2];
+			if (!criarPipe(pedidos) || !criarPipe(respostas)) {
+				std::cerr << "Nao foi possivel criar os pipes" << std::endl;
+				return;
+			}
+
+			auto inicio = relogio::now();
+			std::optional<ServidorComandos::Relatorio> relatorio;
+			std::thread servidor([&] {
+				relatorio = ServidorComandos::servir(armario, pedidos[0], respostas[1]);
+				fecharDescritor(respostas[1]);
+			});
+
+			if (pipeline) {
+				// Uma thread envia tudo (em blocos), esta le as respostas ao mesmo tempo
+				std::thread envio([&] {
+					std::string bloco;
+					for (const std::string& c : comandos) {
+						bloco += c;
+						if (bloco.size() >= 16 * 1024) {
+							escreverTudo(pedidos[1], bloco.data(), bloco.size());
+							bloco.clear();
+						}
+					}
+					escreverTudo(pedidos[1], bloco.data(), bloco.size());
+					fecharDescritor(pedidos[1]);
+				});
+				lerRespostas(respostas[0], (long long)comandos.size());
+				envio.join();
+			}
+			else {
+				// Pedido -> resposta -> pedido: nunca ha mais do que um comando por lote
+				for (const std::string& c : comandos) {
+					escreverTudo(pedidos[1], c.data(), c.size());
+					lerRespostas(respostas[0], 1);
+				}
+				fecharDescritor(pedidos[1]);
+			}
+
+			servidor.join();
+			double segundos = std::chrono::duration<double>(relogio::now() - inicio).count();
+			fecharDescritor(pedidos[0]);
+			fecharDescritor(respostas[0]);
+
+			reportarServidor(opcoes, tamanho, cliente, *relatorio, segundos);
+		}
+	}
+
+	bool lerOpcoes(int argc, char** argv, Opcoes& opcoes) {
+		for (int i = 1; i < argc; i++) {
+			std::string a = argv[i];
+			bool temValor = i + 1 < argc;
+			if (a == "--min" && temValor) {
+				opcoes.minimo = std::atoll(argv[++i]);
+			}
+			else if (a == "--max" && temValor) {
+				opcoes.maximo = std::atoll(argv[++i]);
+			}
+			else if (a == "--ops" && temValor) {
+				opcoes.operacoes = std::atoi(argv[++i]);
+			}
+			else if (a == "--falhas" && temValor) {
+				opcoes.falhas = std::atof(argv[++i]);
+			}
+			else if (a == "--zipf" && temValor) {
+				opcoes.zipf = std::atof(argv[++i]);
+			}
+			else if (a == "--filtro") {
+				opcoes.filtro = true;
+			}
+			else if (a == "--memoria") {
+				opcoes.memoria = true;
+			}
+			else if (a == "--indices") {
+				opcoes.indices = true;
+			}
+			else if (a == "--bloom") {
+				opcoes.bloom = true;
+			}
+			else if (a == "--servidor") {
+				opcoes.servidor = true;
+			}
+			else if (a == "--json") {
+				opcoes.json = true;
+			}
+			else if (a == "--metricas") {
+				opcoes.metricas = true;
+			}
+			else {
+				return false;
+			}
+		}
+		return opcoes.minimo >= 10 && opcoes.maximo >= opcoes.minimo && opcoes.maximo <= 100000000
+			&& opcoes.operacoes > 0 && opcoes.falhas >= 0 && opcoes.falhas <= 1
+			&& opcoes.zipf > 0 && opcoes.zipf != 1;
+	}
+
+	// Metricas da Instrumentacao (--metricas) em stderr, para nao se misturarem com os resultados
+	int terminar(const Opcoes& opcoes) {
+		if (opcoes.metricas) {
+			std::cerr << (opcoes.json ? Instrumentacao::exportarJSON() : Instrumentacao::exportarTexto());
+		}
+		return 0;
+	}
+}
+
+int main(int argc, char** argv)
+{
+	Opcoes opcoes;
+	if (!lerOpcoes(argc, argv, opcoes)) {
+		std::cerr << "Uso: ex2_bench [--min N] [--max N] [--ops N] [--falhas F] [--zipf T] [--filtro] [--memoria] [--indices] [--bloom] [--servidor] [--json] [--metricas]" << std::endl;
+		return 1;
+	}
+
+	if (opcoes.memoria) {
+		if (!opcoes.json) {
+			std::cout << "tamanho,distribuicao,indice,bytes,bytes_por_nif,ns_por_procura" << std::endl;
+		}
+		for (long long tamanho = opcoes.minimo; tamanho <= opcoes.maximo; tamanho *= 10) {
+			compararMemoria(opcoes, tamanho);
+		}
+		return terminar(opcoes);
+	}
+
+	if (opcoes.indices) {
+		if (!opcoes.json) {
+			std::cout << "tamanho,indice,operacao,operacoes,ns_por_op" << std::endl;
+		}
+		for (long long tamanho = opcoes.minimo; tamanho <= opcoes.maximo; tamanho *= 10) {
+			compararIndices(opcoes, tamanho);
+		}
+		return terminar(opcoes);
+	}
+
+	if (opcoes.bloom) {
+		if (!opcoes.json) {
+			std::cout << "tamanho,ocupacao,consultas,falsos_positivos,fpr_pct" << std::endl;
+		}
+		for (long long tamanho = opcoes.minimo; tamanho <= opcoes.maximo; tamanho *= 10) {
+			medirFiltroBloom(opcoes, tamanho);
+		}
+		return terminar(opcoes);
+	}
+
+	if (opcoes.servidor) {
+		if (!opcoes.json) {
+			std::cout << "tamanho,cliente,pedidos,pedidos_por_s,lotes,pedidos_por_lote" << std::endl;
+		}
+		for (long long tamanho = opcoes.minimo; tamanho <= opcoes.maximo; tamanho *= 10) {
+			medirServidor(opcoes, tamanho);
+		}
+		return terminar(opcoes);
+	}
+
+	if (!opcoes.json) {
+		std::cout << "tamanho,carga,operacoes,ops_por_s,p50_ns,p99_ns,pico_rss_kb" << std::endl;
+	}
+	for (long long tamanho = opcoes.minimo; tamanho <= opcoes.maximo; tamanho *= 10) {
+		correrTamanho(opcoes, tamanho);
+	}
+	return terminar(opcoes);
+}